@@ -0,0 +1,336 @@
+// Headless benchmark runner for the Stella core.
+//
+// Loads a ROM through Console/Cartridge::create and runs it frame by frame
+// through Console::update() with no video, audio or input attached, then
+// reports throughput and per-frame wall time percentiles.
+//
+// Usage: stella-bench [-frames N] [-warmup N] [-cpu core] [-pitch N]
+//                     [-rgb 16|32] [-catchup] [-skip N] [-crc] [-state]
+//                     [-rewind] [-profile file] romfile
+//
+//   -frames N   number of timed frames to run (default 3000)
+//   -warmup N   number of untimed frames run before measuring (default 60)
+//   -cpu core   6502 core to run: "switch", "threaded" (default) or "jit"
+//   -pitch N    draw into a caller supplied buffer with N bytes per line
+//               instead of the TIA's own frame buffers
+//   -rgb 16|32  have the TIA convert the frames to RGB565 or RGB888 pixels
+//               in a caller supplied buffer (and checksum those)
+//   -catchup    have the TIA hold back the register writes which only change
+//               what's drawn and draw each scanline once they're all known
+//   -skip N     run N frames without drawing them after each drawn one, like
+//               the frontend's frameskip (only the drawn frames are
+//               checksummed)
+//   -crc        checksum the frame buffer after every frame (excluded
+//               from the timings) so two builds can be checked for
+//               identical output
+//   -state      time saveState()/loadState() and check that replaying the
+//               timed frames from a loaded state gives the same output
+//   -rewind     time capturing every frame into a RewindBuffer, then step
+//               back through the history and check that running forward
+//               again reaches the same state
+//   -profile f  profile the 6502 program over the timed frames and write
+//               the report to file f (only in the stella-profile build made
+//               by "make profile", which has the M6502_TRACE hooks)
+#include <sys/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "bspf.hxx"
+#include "Console.hxx"
+#include "Deserializer.hxx"
+#include "M6502.hxx"
+#include "M6502Profiler.hxx"
+#include "MediaSrc.hxx"
+#include "RewindBuffer.hxx"
+#include "Serializer.hxx"
+#include "Sound.hxx"
+#include "System.hxx"
+
+// Globals the core expects the frontend to provide
+uInt32 console_controleurtype = 0;
+
+static unsigned long bench_timer_read(void) {
+	struct timeval tval;
+
+	gettimeofday(&tval, 0);
+	return ((tval.tv_sec*1000000) + (tval.tv_usec));
+}
+
+static uInt32 bench_adler32(uInt32 adler, const uInt8* buf, uInt32 len) {
+	uInt32 a = adler & 0xffff, b = (adler >> 16) & 0xffff;
+
+	while (len--) {
+		a = (a + *buf++) % 65521;
+		b = (b + a) % 65521;
+	}
+	return (b << 16) | a;
+}
+
+// Checksum the 300 lines of a frame, whatever its pitch
+static uInt32 bench_frame_crc(uInt32 crc, const uInt8* frame, uInt32 width, uInt32 pitch) {
+	for (uInt32 line = 0; line < 300; line++)
+		crc = bench_adler32(crc, frame + line * pitch, width);
+	return crc;
+}
+
+static void usage(const char* prg) {
+	fprintf(stderr, "Usage: %s [-frames N] [-warmup N] [-cpu core] [-pitch N] [-rgb 16|32] [-catchup] [-skip N] [-crc] [-state] [-rewind] [-profile file] romfile\n", prg);
+	exit(1);
+}
+
+int main(int argc, char *argv[]) {
+	const char* romName = 0;
+	const char* profileName = 0;
+	uInt32 frames = 3000, warmup = 60, pitch = 0, rgb = 0, skip = 0;
+	bool doCrc = false, doState = false, doRewind = false, catchUp = false;
+	Console::CPUCore core = Console::CPUThreaded;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-frames") && (i + 1 < argc))
+			frames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-warmup") && (i + 1 < argc))
+			warmup = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-cpu") && (i + 1 < argc)) {
+			i++;
+			if (!strcmp(argv[i], "switch"))
+				core = Console::CPUSwitch;
+			else if (!strcmp(argv[i], "threaded"))
+				core = Console::CPUThreaded;
+			else if (!strcmp(argv[i], "jit"))
+				core = Console::CPUJit;
+			else
+				usage(argv[0]);
+		}
+		else if (!strcmp(argv[i], "-pitch") && (i + 1 < argc))
+			pitch = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-rgb") && (i + 1 < argc)) {
+			rgb = atoi(argv[++i]);
+			if ((rgb != 16) && (rgb != 32))
+				usage(argv[0]);
+		}
+		else if (!strcmp(argv[i], "-catchup"))
+			catchUp = true;
+		else if (!strcmp(argv[i], "-skip") && (i + 1 < argc))
+			skip = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-crc"))
+			doCrc = true;
+		else if (!strcmp(argv[i], "-state"))
+			doCrc = doState = true;
+		else if (!strcmp(argv[i], "-rewind"))
+			doRewind = true;
+		else if (!strcmp(argv[i], "-profile") && (i + 1 < argc))
+			profileName = argv[++i];
+		else if (argv[i][0] == '-')
+			usage(argv[0]);
+		else
+			romName = argv[i];
+	}
+	// Bytes of each line that hold pixels
+	uInt32 width = rgb ? (160 * rgb / 8) : 160;
+	if (rgb && (pitch == 0))
+		pitch = width;
+
+	if ((romName == 0) || (frames == 0) || ((pitch != 0) && (pitch < width)))
+		usage(argv[0]);
+#ifndef M6502_TRACE
+	if (profileName) {
+		fprintf(stderr, "This build can't profile, use stella-profile (make profile)\n");
+		return 1;
+	}
+#endif
+
+	// Load the file
+	FILE *romfile = fopen(romName, "rb");
+	if (romfile == NULL) {
+		fprintf(stderr, "Couldn't open %s\n", romName);
+		return 1;
+	}
+	fseek(romfile, 0, SEEK_END);
+	uInt32 size = ftell(romfile);
+	rewind(romfile);
+	uInt8* image = (uInt8*) malloc(size);
+	fread(image, size, 1, romfile);
+	fclose(romfile);
+
+	// Init the emulation with a null sound device
+	Sound* sound = new Sound();
+	Console* console = new Console(image, size, romName, *sound, core);
+	MediaSource& media = *console->myMediaSource;
+	System& system = console->system();
+
+	// Frames are checksummed from the caller's buffer when there's one
+	uInt8* output = 0;
+	if (pitch != 0) {
+		output = (uInt8*) calloc(pitch, 300);
+		media.setOutputBuffer(output, pitch, (rgb == 16) ? MediaSource::RGB565 :
+			(rgb == 32) ? MediaSource::RGB888 : MediaSource::Indexed8);
+	}
+	else
+		pitch = 160;
+	media.setCatchUpRendering(catchUp);
+
+	for (uInt32 i = 0; i < warmup; i++)
+		console->update();
+
+	// Snapshot the machine so the timed frames can be replayed
+	Serializer state;
+	if ((doState || doRewind) && !console->saveState(state)) {
+		fprintf(stderr, "saveState failed\n");
+		return 1;
+	}
+
+#ifdef M6502_TRACE
+	M6502Profiler* profiler = profileName ? new M6502Profiler(system) : 0;
+#endif
+
+	std::vector<uInt32> frameTime(frames);
+	unsigned long long cycles = 0;
+	uInt32 crc = 1;
+
+	unsigned long start = bench_timer_read();
+	for (uInt32 i = 0; i < frames; i++) {
+		bool draw = (i % (skip + 1)) == 0;
+		unsigned long t0 = bench_timer_read();
+		console->update(draw);
+		unsigned long t1 = bench_timer_read();
+
+		// The TIA resets the system cycle counter at the start of each frame
+		cycles += system.cycles();
+		frameTime[i] = (uInt32)(t1 - t0);
+
+		if (doCrc && draw) {
+			crc = bench_frame_crc(crc, output ? output : media.currentFrameBuffer(), width, pitch);
+			start += bench_timer_read() - t1;
+		}
+	}
+	double elapsed = (bench_timer_read() - start) / 1000000.0;
+
+#ifdef M6502_TRACE
+	if (profiler) {
+		std::ofstream report(profileName);
+		profiler->report(report);
+		delete profiler;
+		if (!report) {
+			fprintf(stderr, "Couldn't write %s\n", profileName);
+			return 1;
+		}
+	}
+#endif
+
+	std::sort(frameTime.begin(), frameTime.end());
+
+	printf("rom            : %s (%u bytes)\n", romName, size);
+	printf("cpu            : %s\n", system.m6502().name());
+	printf("frames         : %u (+%u warmup), %u scanlines/frame\n",
+		frames, warmup, media.scanlines());
+	printf("elapsed        : %.3f s\n", elapsed);
+	printf("frames/sec     : %.1f\n", frames / elapsed);
+	printf("cpu cycles/sec : %.0f (%.2fx NTSC)\n", cycles / elapsed,
+		(cycles / elapsed) / 1193191.66666667);
+	printf("frame time us  : min %u  p50 %u  p90 %u  p99 %u  max %u\n",
+		frameTime[0], frameTime[frames / 2], frameTime[(frames * 90) / 100],
+		frameTime[(frames * 99) / 100], frameTime[frames - 1]);
+	if (doCrc)
+		printf("frame crc      : %08x\n", crc);
+
+	if (doState) {
+		const uInt32 loops = 1000;
+		Serializer out;
+
+		unsigned long t0 = bench_timer_read();
+		for (uInt32 i = 0; i < loops; i++) {
+			out.reset();
+			console->saveState(out);
+		}
+		unsigned long t1 = bench_timer_read();
+		for (uInt32 i = 0; i < loops; i++) {
+			Deserializer in(out.data(), out.size());
+			console->loadState(in);
+		}
+		unsigned long t2 = bench_timer_read();
+
+		printf("state size     : %u bytes\n", out.size());
+		printf("state save us  : %.2f\n", (double)(t1 - t0) / loops);
+		printf("state load us  : %.2f\n", (double)(t2 - t1) / loops);
+
+		// Replay the timed frames from the snapshot taken before them
+		Deserializer in(state.data(), state.size());
+		if (!console->loadState(in)) {
+			fprintf(stderr, "loadState failed\n");
+			return 1;
+		}
+		uInt32 replayCrc = 1;
+		for (uInt32 i = 0; i < frames; i++) {
+			bool draw = (i % (skip + 1)) == 0;
+			console->update(draw);
+			if (draw)
+				replayCrc = bench_frame_crc(replayCrc, output ? output : media.currentFrameBuffer(), width, pitch);
+		}
+		printf("replay crc     : %08x (%s)\n", replayCrc,
+			(replayCrc == crc) ? "match" : "MISMATCH");
+		if (replayCrc != crc)
+			return 1;
+	}
+
+	if (doRewind) {
+		RewindBuffer rewind;
+		unsigned long long updateTime = 0, captureTime = 0;
+
+		// Run the timed frames again from the snapshot, capturing each one
+		Deserializer in(state.data(), state.size());
+		console->loadState(in);
+		rewind.capture(*console);
+		for (uInt32 i = 0; i < frames; i++) {
+			unsigned long t0 = bench_timer_read();
+			console->update();
+			unsigned long t1 = bench_timer_read();
+			rewind.capture(*console);
+			unsigned long t2 = bench_timer_read();
+			updateTime += t1 - t0;
+			captureTime += t2 - t1;
+		}
+		uInt32 history = rewind.frames();
+
+		printf("rewind frames  : %u in %u bytes (%.0f bytes/frame)\n",
+			history, rewind.used(), (double)rewind.used() / BSPF_max(history, 1u));
+		printf("rewind capture : %.2f us/frame (%.2f%% of update)\n",
+			(double)captureTime / frames, (100.0 * captureTime) / BSPF_max(updateTime, 1ULL));
+
+		// Step back through the whole history, then run forward again
+		Serializer last, replay;
+		console->saveState(last);
+		uInt32 steps = 0;
+		unsigned long t0 = bench_timer_read();
+		while (rewind.rewind(*console))
+			steps++;
+		unsigned long t1 = bench_timer_read();
+		printf("rewind step us : %.2f\n", (double)(t1 - t0) / BSPF_max(steps, 1u));
+
+		bool match = (steps == history);
+		if (match && (steps == frames)) {
+			console->saveState(replay);
+			match = (replay.size() == state.size()) &&
+				!memcmp(replay.data(), state.data(), state.size());
+		}
+		for (uInt32 i = 0; i < steps; i++)
+			console->update();
+		replay.reset();
+		console->saveState(replay);
+		match = match && (replay.size() == last.size()) &&
+			!memcmp(replay.data(), last.data(), last.size());
+		printf("rewind check   : %s\n", match ? "match" : "MISMATCH");
+		if (!match)
+			return 1;
+	}
+
+	delete console;
+	delete sound;
+	free(output);
+	free(image);
+
+	return 0;
+}
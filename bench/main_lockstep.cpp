@@ -0,0 +1,211 @@
+// Lockstep differential tester for the 6502 cores.
+//
+// Runs the same ROM on two consoles, one per core, one frame at a time.
+// Every instruction (with the registers and cycle count it left) and every
+// read and write made by the instructions is recorded through the
+// M6502_TRACE hooks, and the two traces are compared event by event.  The
+// first divergence is reported with the instructions leading up to it.
+// The frame buffers and the saved console states are compared at the end
+// of every frame too.
+//
+// Usage: stella-lockstep [-frames N] [-cpu core] [-ref core] romfile
+//
+//   -frames N   number of frames to run (default 600)
+//   -cpu core   core under test: "switch", "threaded" (default) or "jit"
+//   -ref core   reference core (default "switch")
+//
+// Built by "make lockstep", with the trace hooks compiled in.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "bspf.hxx"
+#include "Console.hxx"
+#include "M6502.hxx"
+#include "MediaSrc.hxx"
+#include "Serializer.hxx"
+#include "Sound.hxx"
+#include "System.hxx"
+
+#ifndef M6502_TRACE
+#error "The lockstep harness needs the M6502_TRACE hooks, build it with make lockstep"
+#endif
+
+// Globals the core expects the frontend to provide
+uInt32 console_controleurtype = 0;
+
+// Number of instructions shown before a divergence
+#define LOCKSTEP_HISTORY 8
+
+struct Event {
+	uInt8 kind;			// 'I'nstruction, 'R'ead or 'W'rite
+	uInt8 ir;			// opcode, or the byte accessed
+	uInt8 a, x, y, sp, ps;
+	uInt16 pc;			// next instruction, or the address accessed
+	uInt32 cycles;
+};
+
+static bool lockstep_same(const Event& e1, const Event& e2) {
+	return (e1.kind == e2.kind) && (e1.ir == e2.ir) && (e1.pc == e2.pc) &&
+		(e1.cycles == e2.cycles) && ((e1.kind != 'I') ||
+		((e1.a == e2.a) && (e1.x == e2.x) && (e1.y == e2.y) &&
+		(e1.sp == e2.sp) && (e1.ps == e2.ps)));
+}
+
+static void lockstep_print(const char* label, const Event* e) {
+	if (e == 0)
+		printf("  %-8s <end of frame>\n", label);
+	else if (e->kind == 'I')
+		printf("  %-8s op %02x -> pc %04x  a %02x x %02x y %02x sp %02x ps %02x  cycle %u\n",
+			label, e->ir, e->pc, e->a, e->x, e->y, e->sp, e->ps, e->cycles);
+	else
+		printf("  %-8s %s %04x = %02x  cycle %u\n", label,
+			(e->kind == 'W') ? "write" : "read ", e->pc, e->ir, e->cycles);
+}
+
+// Records the events of a frame
+class Recorder : public M6502Tracer {
+	public:
+		std::vector<Event> events;
+
+		virtual void instruction(uInt8 ir, uInt16 pc, uInt8 a, uInt8 x, uInt8 y,
+			uInt8 sp, uInt8 ps, uInt32 cycles) {
+			Event e = { 'I', ir, a, x, y, sp, ps, pc, cycles };
+			events.push_back(e);
+		}
+
+		virtual void access(uInt16 address, uInt8 value, bool write, uInt32 cycles) {
+			Event e = { (uInt8)(write ? 'W' : 'R'), value, 0, 0, 0, 0, 0, address, cycles };
+			events.push_back(e);
+		}
+};
+
+static bool lockstep_core(const char* name, Console::CPUCore& core) {
+	if (!strcmp(name, "switch"))
+		core = Console::CPUSwitch;
+	else if (!strcmp(name, "threaded"))
+		core = Console::CPUThreaded;
+	else if (!strcmp(name, "jit"))
+		core = Console::CPUJit;
+	else
+		return false;
+	return true;
+}
+
+static void usage(const char* prg) {
+	fprintf(stderr, "Usage: %s [-frames N] [-cpu core] [-ref core] romfile\n", prg);
+	exit(1);
+}
+
+int main(int argc, char *argv[]) {
+	const char* romName = 0;
+	uInt32 frames = 600;
+	Console::CPUCore core = Console::CPUThreaded, reference = Console::CPUSwitch;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-frames") && (i + 1 < argc))
+			frames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-cpu") && (i + 1 < argc)) {
+			if (!lockstep_core(argv[++i], core))
+				usage(argv[0]);
+		}
+		else if (!strcmp(argv[i], "-ref") && (i + 1 < argc)) {
+			if (!lockstep_core(argv[++i], reference))
+				usage(argv[0]);
+		}
+		else if (argv[i][0] == '-')
+			usage(argv[0]);
+		else
+			romName = argv[i];
+	}
+	if ((romName == 0) || (frames == 0))
+		usage(argv[0]);
+
+	// Load the file
+	FILE *romfile = fopen(romName, "rb");
+	if (romfile == NULL) {
+		fprintf(stderr, "Couldn't open %s\n", romName);
+		return 1;
+	}
+	fseek(romfile, 0, SEEK_END);
+	uInt32 size = ftell(romfile);
+	rewind(romfile);
+	uInt8* image = (uInt8*) malloc(size);
+	fread(image, size, 1, romfile);
+	fclose(romfile);
+
+	// Both consoles start from the same power-on state, the random numbers
+	// used to fill RAM being the same sequence for each
+	Sound sound1, sound2;
+	Console* console1 = new Console(image, size, romName, sound1, reference);
+	Console* console2 = new Console(image, size, romName, sound2, core);
+	Recorder trace1, trace2;
+	console1->system().m6502().setTracer(&trace1);
+	console2->system().m6502().setTracer(&trace2);
+
+	printf("reference      : %s\n", console1->system().m6502().name());
+	printf("core           : %s\n", console2->system().m6502().name());
+
+	unsigned long long instructions = 0, accesses = 0;
+	for (uInt32 frame = 0; frame < frames; frame++) {
+		trace1.events.clear();
+		trace2.events.clear();
+		console1->update();
+		console2->update();
+
+		// Find the first event which differs
+		const std::vector<Event>& e1 = trace1.events;
+		const std::vector<Event>& e2 = trace2.events;
+		uInt32 n = BSPF_min(e1.size(), e2.size());
+		uInt32 i = 0;
+		while ((i < n) && lockstep_same(e1[i], e2[i]))
+			i++;
+
+		if ((i < n) || (e1.size() != e2.size())) {
+			printf("DIVERGENCE in frame %u at event %u\n", frame, i);
+
+			// Show the instructions leading to it
+			uInt32 start = i, shown = 0;
+			while ((start > 0) && (shown < LOCKSTEP_HISTORY))
+				if (e1[--start].kind == 'I')
+					shown++;
+			for (uInt32 j = start; j < i; j++)
+				lockstep_print("", &e1[j]);
+			lockstep_print("ref", (i < e1.size()) ? &e1[i] : 0);
+			lockstep_print("core", (i < e2.size()) ? &e2[i] : 0);
+			return 1;
+		}
+
+		for (uInt32 j = 0; j < n; j++)
+			if (e1[j].kind == 'I')
+				instructions++;
+			else
+				accesses++;
+
+		// Anything the traces can't show, such as device state
+		Serializer state1, state2;
+		console1->saveState(state1);
+		console2->saveState(state2);
+		bool sameState = (state1.size() == state2.size()) &&
+			!memcmp(state1.data(), state2.data(), state1.size());
+		bool sameFrame = !memcmp(console1->myMediaSource->currentFrameBuffer(),
+			console2->myMediaSource->currentFrameBuffer(), 160 * 300);
+		if (!sameState || !sameFrame) {
+			printf("DIVERGENCE at the end of frame %u: %s differs\n", frame,
+				sameState ? "frame buffer" : "saved state");
+			return 1;
+		}
+	}
+
+	printf("frames         : %u\n", frames);
+	printf("instructions   : %llu\n", instructions);
+	printf("accesses       : %llu\n", accesses);
+	printf("result         : no divergence\n");
+
+	delete console1;
+	delete console2;
+	free(image);
+
+	return 0;
+}
@@ -17,34 +17,52 @@
 //============================================================================
 
 #include <assert.h>
-
-#include <stdio.h>
+#include <string.h>
 
 #include "TIASound.hxx"
-//JGD #include "TIASnd.hxx"
 #include "Console.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
 #include "SoundSDL.hxx"
-#include <math.h>
+
+// Full memory barrier between a ring slot and the index publishing it
+#define SOUND_BARRIER() __sync_synchronize()
+
+// The output rate (44100 Hz) and the NTSC CPU clock (1193182 Hz), both
+// halved so that the ticks of a 65536 cycle gap still fit in an Int32
+static const Int32 ourSampleRate = 22050;
+static const Int32 ourCycleRate = 596591;
+
+// Longest gap between two writes that is still timed, in CPU cycles
+static const Int32 ourMaxDelta = 65536;
+
+// Samples the ring should hold when a frame is added: enough to ride out
+// a late frame without making the sound lag the picture
+static const Int32 ourTargetFill = 768;
+
+// Largest change to the playback rate of a frame (in 1/65536ths, ~0.5%)
+static const Int32 ourMaxSkew = 328;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 SoundSDL::SoundSDL(uInt32 fragsize)
     : myIsInitializedFlag(false),
       myFragmentSizeLogBase2(0),
       myIsMuted(false),
-      myVolume(100)
+      myVolume(100),
+      myQueueOverflow(false),
+      myWriteTicks(0),
+      myFrameCount(0),
+      myResamplePosition(0),
+      mySampleHead(0),
+      mySampleTail(0),
+      myLastSample(0)
 {
-    myIsMuted = false;
- //   myFragmentSizeLogBase2 = log((double)fragsize) / log(2.0);
+  memset(myRegisters, 0, sizeof(myRegisters));
+  memset(myFrameSamples, 0, sizeof(myFrameSamples));
 
   Tia_sound_init(31400, 44100);
-  /*
-  myTIASound.reset();
-  myTIASound.outputFrequency(22050);
-  myTIASound.tiaFrequency(22050);
-  myTIASound.channels(1);
-*/
-	myIsInitializedFlag = true;
+
+  myIsInitializedFlag = true;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -77,7 +95,7 @@ void SoundSDL::mute(bool state)
 
     myIsMuted = state;
 
-    myRegWriteQueue.clear();
+    flushQueue();
   }
 }
 
@@ -88,7 +106,7 @@ void SoundSDL::reset()
 	{
 		myIsMuted = false;
 		myLastRegisterSetCycle = 0;
-		myRegWriteQueue.clear();
+		flushQueue();
 	}
 }
 
@@ -107,35 +125,202 @@ void SoundSDL::adjustVolume(Int8 direction)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void SoundSDL::set(uInt16 addr, uInt8 value, Int32 cycle)
 {
-//	RegWrite info;
-//	info.addr = addr;
-//	info.value = value;
-//	info.delta = 0;
-//	myRegWriteQueue.enqueue(info);
-	Update_tia_sound(addr, value);
-  //JGD myTIASound.set(addr, value);
+  // Cycles since the previous write, after which the audio thread has to
+  // apply this one
+  Int32 delta = BSPF_max(0, BSPF_min(cycle - myLastRegisterSetCycle, ourMaxDelta));
+  myLastRegisterSetCycle = cycle;
+
+  uInt32 reg = addr - 0x15;
+  if(reg < 6)
+  {
+    myRegisters[reg] = value;
+  }
+
+  RegWrite info;
+  info.addr = addr;
+  info.value = value;
+  info.delta = delta;
+
+  if(myQueueOverflow)
+  {
+    // Some writes were lost while the queue was full, so send all the
+    // registers again as soon as there's room for them
+    if(myRegWriteQueue.space() < 6)
+    {
+      return;
+    }
+
+    for(uInt32 i = 0; i < 6; ++i)
+    {
+      info.addr = 0x15 + i;
+      info.value = myRegisters[i];
+      myRegWriteQueue.enqueue(info);
+      info.delta = 0;
+    }
+    myQueueOverflow = false;
+  }
+  else if(!myRegWriteQueue.enqueue(info))
+  {
+    myQueueOverflow = true;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool SoundSDL::save(Serializer& out)
+{
+  out.putString("TIASound");
+
+  // AUDC0, AUDC1, AUDF0, AUDF1, AUDV0, AUDV1
+  out.putBytes(myRegisters, 6);
+  out.putInt(myLastRegisterSetCycle);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundSDL::flushQueue()
+{
+  while(myRegWriteQueue.size() > 0)
+  {
+    RegWrite& info = myRegWriteQueue.front();
+    Update_tia_sound(info.addr, info.value);
+    myRegWriteQueue.dequeue();
+  }
+  myWriteTicks = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundSDL::renderCycles(uInt32 cycles)
+{
+  myWriteTicks += cycles * ourSampleRate;
+
+  Int32 samples = BSPF_min(myWriteTicks / ourCycleRate,
+      (Int32)(sizeof(myFrameSamples) - 1 - myFrameCount));
+  if(samples > 0)
+  {
+    Tia_process(myFrameSamples + 1 + myFrameCount, samples);
+    myFrameCount += samples;
+  }
+
+  // The remainder is carried over to the next write
+  myWriteTicks %= ourCycleRate;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundSDL::processFrame()
+{
+  if(!myIsInitializedFlag)
+  {
+    return;
+  }
+
+  // Render the frame at the nominal rate, up to each write and then on to
+  // the current cycle
+  myFrameCount = 0;
+  while(myRegWriteQueue.size() > 0)
+  {
+    RegWrite& info = myRegWriteQueue.front();
+    renderCycles(info.delta);
+    Update_tia_sound(info.addr, info.value);
+    myRegWriteQueue.dequeue();
+  }
+
+  Int32 cycle = mySystem->cycles();
+  renderCycles(BSPF_max(0, BSPF_min(cycle - myLastRegisterSetCycle, ourMaxDelta)));
+  myLastRegisterSetCycle = cycle;
+
+  uInt32 mask = sizeof(mySamples) - 1;
+  uInt32 tail = mySampleTail;
+  Int32 fill = (tail - mySampleHead) & mask;
+  SOUND_BARRIER();
+
+  // If the ring ran dry (after a pause or a slow frame) pad it back up to
+  // the target at once, rather than let the rate control crawl back
+  if(fill == 0)
+  {
+    for(; fill < ourTargetFill; ++fill)
+    {
+      mySamples[tail] = myFrameSamples[0];
+      tail = (tail + 1) & mask;
+    }
+  }
+
+  // Play this frame slightly faster when the ring is above its target and
+  // slightly slower when below, by stepping through the frame's samples
+  // by a little more or less than one per output sample
+  Int32 error = BSPF_max(-ourTargetFill, BSPF_min(fill - ourTargetFill, ourTargetFill));
+  uInt32 step = 65536 + (ourMaxSkew * error) / ourTargetFill;
+
+  // Linear interpolation between consecutive samples, dropping whatever
+  // doesn't fit the ring
+  uInt32 position = myResamplePosition;
+  uInt32 end = myFrameCount << 16;
+  for(; position < end; position += step)
+  {
+    const uInt8* sample = myFrameSamples + (position >> 16);
+    uInt32 frac = position & 0xffff;
+    uInt8 value = (uInt8)((sample[0] * (65536 - frac) + sample[1] * frac) >> 16);
+
+    if(fill < (Int32)mask)
+    {
+      mySamples[tail] = value;
+      tail = (tail + 1) & mask;
+      ++fill;
+    }
+  }
+  myResamplePosition = position - end;
+  myFrameSamples[0] = myFrameSamples[myFrameCount];
+
+  // Publish the samples to the audio callback
+  SOUND_BARRIER();
+  mySampleTail = tail;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void SoundSDL::processFragment(uInt8* stream, Int32 length)
 {
-	if(!myIsInitializedFlag) { return; }
+  if(!myIsInitializedFlag)
+  {
+    return;
+  }
+
+  uInt32 mask = sizeof(mySamples) - 1;
+  uInt32 head = mySampleHead;
+  Int32 count = BSPF_min((Int32)((mySampleTail - head) & mask), length);
+  SOUND_BARRIER();
+
+  for(Int32 i = 0; i < count; ++i)
+  {
+    stream[i] = mySamples[head];
+    head = (head + 1) & mask;
+  }
+  if(count > 0)
+  {
+    myLastSample = stream[count - 1];
+  }
+
+  // Let processFrame() reuse the samples
+  SOUND_BARRIER();
+  mySampleHead = head;
+
+  // Hold the last sample on an underrun rather than click
+  memset(stream + count, myLastSample, length - count);
 
-//	RegWrite& info = myRegWriteQueue.front();
-	Tia_process(stream, length);
-  //JGD myTIASound.process(stream, length);
-//	myRegWriteQueue.dequeue();
+  if(myIsMuted)
+  {
+    memset(stream, 0, length);
+  }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 SoundSDL::RegWriteQueue::RegWriteQueue(uInt32 capacity)
-    : myCapacity(capacity),
+    : myMask(capacity - 1),
       myBuffer(0),
-      mySize(0),
       myHead(0),
       myTail(0)
 {
-  myBuffer = new RegWrite[myCapacity];
+  assert((capacity & myMask) == 0);
+  myBuffer = new RegWrite[capacity];
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -147,69 +332,68 @@ SoundSDL::RegWriteQueue::~RegWriteQueue()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void SoundSDL::RegWriteQueue::clear()
 {
-  myHead = myTail = mySize = 0;
+  myHead = myTail;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void SoundSDL::RegWriteQueue::dequeue()
 {
-  if(mySize > 0)
+  if(size() > 0)
   {
-    myHead = (myHead + 1) % myCapacity;
-    --mySize;
+    // Finish with the slot before the producer can reuse it
+    SOUND_BARRIER();
+    myHead = (myHead + 1) & myMask;
   }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-double SoundSDL::RegWriteQueue::duration()
+uInt32 SoundSDL::RegWriteQueue::duration()
 {
-  double duration = 0.0;
-  for(uInt32 i = 0; i < mySize; ++i)
+  uInt32 tail = myTail;
+  SOUND_BARRIER();
+
+  uInt32 duration = 0;
+  for(uInt32 i = myHead; i != tail; i = (i + 1) & myMask)
   {
-    duration += myBuffer[(myHead + i) % myCapacity].delta;
+    duration += myBuffer[i].delta;
   }
   return duration;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void SoundSDL::RegWriteQueue::enqueue(const RegWrite& info)
+bool SoundSDL::RegWriteQueue::enqueue(const RegWrite& info)
 {
-  // If an attempt is made to enqueue more than the queue can hold then
-  // we'll enlarge the queue's capacity.
-  if(mySize == myCapacity)
+  uInt32 tail = myTail;
+  uInt32 next = (tail + 1) & myMask;
+  if(next == myHead)
   {
-    grow();
+    return false;
   }
 
-  myBuffer[myTail] = info;
-  myTail = (myTail + 1) % myCapacity;
-  ++mySize;
+  // Fill in the slot before publishing it to the consumer
+  myBuffer[tail] = info;
+  SOUND_BARRIER();
+  myTail = next;
+
+  return true;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 SoundSDL::RegWrite& SoundSDL::RegWriteQueue::front()
 {
-  assert(mySize != 0);
+  assert(size() != 0);
+  SOUND_BARRIER();
   return myBuffer[myHead];
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt32 SoundSDL::RegWriteQueue::size() const
 {
-  return mySize;
+  return (myTail - myHead) & myMask;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void SoundSDL::RegWriteQueue::grow()
+uInt32 SoundSDL::RegWriteQueue::space() const
 {
-  RegWrite* buffer = new RegWrite[myCapacity * 2];
-  for(uInt32 i = 0; i < mySize; ++i)
-  {
-    buffer[i] = myBuffer[(myHead + i) % myCapacity];
-  }
-  myHead = 0;
-  myTail = mySize;
-  myCapacity = myCapacity * 2;
-  delete[] myBuffer;
-  myBuffer = buffer;
+  return myMask - size();
 }
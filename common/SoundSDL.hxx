@@ -23,8 +23,6 @@
 #include "bspf.hxx"
 #include "MediaSrc.hxx"
 
-//JGD #include "TiaSnd.hxx"
-
 /**
   This class implements the sound API for SDL.
 
@@ -62,6 +60,14 @@ virtual void callback(uInt8* stream, int len);
     */
     virtual void mute(bool state);
 
+    /**
+      Renders the samples of the frame that was just emulated, applying the
+      queued register writes at the sample they fall on, and hands them to
+      the audio callback through the sample ring.  The number of samples is
+      nudged up or down slightly to keep the ring near its target fill.
+    */
+    virtual void processFrame();
+
     /**
       Resets the sound device.
     */
@@ -93,9 +99,20 @@ virtual void callback(uInt8* stream, int len);
     */
     virtual void adjustVolume(Int8 direction);
 
+    /**
+      Saves the current state of the sound registers.  The registers are
+      taken from the writes made by the emulation, since the writes of the
+      current frame are still queued.
+
+      @param out The serializer device to save to.
+      @return The result of the save.  True on success, false on failure.
+    */
+    virtual bool save(Serializer& out);
+
   protected:
     /**
-      Invoked by the sound callback to process the next sound fragment.
+      Invoked by the sound callback to copy the next sound fragment out of
+      the sample ring.  Runs on the audio thread.
 
       @param stream Pointer to the start of the fragment
       @param length Length of the fragment
@@ -108,22 +125,23 @@ virtual void callback(uInt8* stream, int len);
     {
       uInt16 addr;
       uInt8 value;
-      double delta;
+      uInt32 delta;   // CPU cycles since the previous write
     };
 
     /**
-      A queue class used to hold TIA sound register writes before being
-      processed while creating a sound fragment.
+      A lock-free single producer / single consumer queue used to hold
+      TIA sound register writes until the frame's samples are rendered.
+      Only the producer may call enqueue() and space(), and only the
+      consumer may call the other methods.
     */
     class RegWriteQueue
     {
       public:
         /**
-          Create a new queue instance with the specified initial
-          capacity.  If the queue ever reaches its capacity then it will
-          automatically increase its size.
+          Create a new queue instance with the specified capacity, which
+          must be a power of two.  One entry is always kept free.
         */
-        RegWriteQueue(uInt32 capacity = 512);
+        RegWriteQueue(uInt32 capacity = 1024);
 
         /**
           Destroy this queue instance.
@@ -132,7 +150,7 @@ virtual void callback(uInt8* stream, int len);
 
       public:
         /**
-          Clear any items stored in the queue.
+          Discard all the items stored in the queue.
         */
         void clear();
 
@@ -142,14 +160,16 @@ virtual void callback(uInt8* stream, int len);
         void dequeue();
 
         /**
-          Return the duration of all the items in the queue.
+          Return the duration in CPU cycles of all the items in the queue.
         */
-        double duration();
+        uInt32 duration();
 
         /**
           Enqueue the specified object.
+
+          @return false if the queue is full and the object was dropped
         */
-        void enqueue(const RegWrite& info);
+        bool enqueue(const RegWrite& info);
 
         /**
           Return the item at the front on the queue.
@@ -165,22 +185,33 @@ virtual void callback(uInt8* stream, int len);
         */
         uInt32 size() const;
 
-      private:
-        // Increase the size of the queue
-        void grow();
+        /**
+          Answers the number of items that can still be enqueued.
+
+          @return The free space in the queue.
+        */
+        uInt32 space() const;
 
       private:
-        uInt32 myCapacity;
+        uInt32 myMask;
         RegWrite* myBuffer;
-        uInt32 mySize;
-        uInt32 myHead;
-        uInt32 myTail;
+
+        // Only written by the consumer
+        volatile uInt32 myHead;
+
+        // Only written by the producer
+        volatile uInt32 myTail;
     };
 
   private:
-//JGD    // TIASound emulation object
-//JGD    TIASound myTIASound;
-    
+    // Apply the writes still in the queue right away
+    void flushQueue();
+
+    // Append the samples lasting the given number of CPU cycles to
+    // myFrameSamples
+    void renderCycles(uInt32 cycles);
+
+  private:
     // Indicates if the sound device was successfully initialized
     bool myIsInitializedFlag;
 
@@ -196,7 +227,34 @@ virtual void callback(uInt8* stream, int len);
     // Queue of TIA register writes
     RegWriteQueue myRegWriteQueue;
 
+    // Indicates writes were dropped because the queue was full
+    bool myQueueOverflow;
+
+    // Last value written to AUDC0, AUDC1, AUDF0, AUDF1, AUDV0 and AUDV1
+    uInt8 myRegisters[6];
+
+    // Output ticks (CPU cycles * output rate) not yet rendered as a sample
+    Int32 myWriteTicks;
+
+    // Samples of the current frame at the nominal rate, after the last
+    // sample of the previous frame
+    uInt8 myFrameSamples[2048];
+    uInt32 myFrameCount;
+
+    // Position of the next output sample in myFrameSamples (16.16)
+    uInt32 myResamplePosition;
+
+    // Ring of samples waiting for the audio callback, a power of two long
+    uInt8 mySamples[4096];
+
+    // Only written by the audio callback
+    volatile uInt32 mySampleHead;
+
+    // Only written by processFrame()
+    volatile uInt32 mySampleTail;
 
+    // Last sample played, repeated if the ring runs dry
+    uInt8 myLastSample;
 };
 
 #endif
@@ -108,6 +108,49 @@ Cartridge::~Cartridge()
 {
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 Cartridge::currentBank(uInt16) const
+{
+  return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+System::PageAccess* Cartridge::createBankMap(uInt16 start, uInt16 end,
+    uInt8* peekBase, uInt8* pokeBase, uInt32 bankSize, uInt32 banks,
+    System::PageType type)
+{
+  uInt16 shift = mySystem->pageShift();
+  uInt32 pages = (end - start) >> shift;
+  System::PageAccess* map = new System::PageAccess[banks * pages];
+
+  for(uInt32 bank = 0; bank < banks; ++bank)
+  {
+    for(uInt32 page = 0; page < pages; ++page)
+    {
+      uInt32 offset = bank * bankSize + (page << shift);
+      System::PageAccess& access = map[bank * pages + page];
+
+      access.directPeekBase = peekBase ? &peekBase[offset] : 0;
+      access.directPokeBase = pokeBase ? &pokeBase[offset] : 0;
+      access.device = this;
+      access.type = type;
+    }
+  }
+
+  mySystem->prepareMappings(map, banks * pages);
+  return map;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Cartridge::installBank(const System::PageAccess* map, uInt16 start,
+    uInt16 end, uInt32 bank)
+{
+  uInt16 shift = mySystem->pageShift();
+  uInt32 pages = (end - start) >> shift;
+
+  mySystem->setPageAccess(start >> shift, pages, &map[bank * pages]);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 string Cartridge::autodetectType(const uInt8* image, uInt32 size)
 {
@@ -24,6 +24,7 @@ class System;
 
 #include "bspf.hxx"
 #include "Device.hxx"
+#include "System.hxx"
 
 /**
   A cartridge is a device which contains the machine code for a 
@@ -57,6 +58,16 @@ class Cartridge : public Device
     */
     virtual ~Cartridge();
 
+    /**
+      Get the bank (or slice) mapped at the specified address, used to
+      tell the banks apart in the profiler's report.  Cartridges without
+      bankswitching answer 0.
+
+      @param address An address in the cartridge's space
+      @return The bank the address reads from
+    */
+    virtual uInt16 currentBank(uInt16 address) const;
+
   private:
     /**
       Try to auto-detect the bankswitching type of the cartridge
@@ -97,6 +108,38 @@ class Cartridge : public Device
     */
     static bool isProbablyE7(const uInt8* image, uInt32 size);
 
+  protected:
+    /**
+      Build the page accesses mapping each of the specified banks of
+      memory at the pages from start to end, so that switching one in
+      is a single copy by installBank.  Bank n maps peekBase (or
+      pokeBase) + n * bankSize at start; one of the bases may be the
+      null pointer.
+
+      @param start The address of the first page of the segment
+      @param end The address of the page following the segment
+      @param peekBase The memory read by bank 0, or the null pointer
+      @param pokeBase The memory written by bank 0, or the null pointer
+      @param bankSize The distance in memory between banks
+      @param banks The number of banks
+      @param type The type of the pages
+      @return The accesses, bank after bank, to be deleted with delete[]
+    */
+    System::PageAccess* createBankMap(uInt16 start, uInt16 end,
+        uInt8* peekBase, uInt8* pokeBase, uInt32 bankSize, uInt32 banks,
+        System::PageType type);
+
+    /**
+      Install the specified bank of a map built by createBankMap
+
+      @param map The map built for the segment
+      @param start The address of the first page of the segment
+      @param end The address of the page following the segment
+      @param bank The bank to install
+    */
+    void installBank(const System::PageAccess* map, uInt16 start, uInt16 end,
+        uInt32 bank);
+
   protected:
     // Indicates if the bank has changed somehow (a bankswitch has occurred)
     bool myBankChanged;
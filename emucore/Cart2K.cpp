@@ -19,6 +19,8 @@
 #include <assert.h>
 #include "Cart2K.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -65,10 +67,28 @@ void Cartridge2K::install(System& system)
   for(uInt32 address = 0x1000; address < 0x2000; address += (1 << shift))
   {
     access.directPeekBase = &myImage[address & 0x07FF];
+    access.type = System::PageROM;
     mySystem->setPageAccess(address >> mySystem->pageShift(), access);
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Cartridge2K::save(Serializer& out)
+{
+  out.putString(name());
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Cartridge2K::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 Cartridge2K::peek(uInt16 address)
 {
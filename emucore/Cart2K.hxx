@@ -69,6 +69,22 @@ class Cartridge2K : public Cartridge
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
   public:
     /**
       Get the byte at the specified address
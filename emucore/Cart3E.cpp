@@ -20,6 +20,8 @@
 #include "Random.hxx"
 #include "Cart3E.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include "TIA.hxx"
 #include <iostream>
 
@@ -42,11 +44,19 @@ Cartridge3E::Cartridge3E(const uInt8* image, uInt32 size)
   {
     myRam[i] = random.next();
   }
+
+  // The page accesses of the banks are built by install
+  myBankMap = 0;
+  myRAMReadMap = 0;
+  myRAMWriteMap = 0;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Cartridge3E::~Cartridge3E()
 {
+  delete[] myBankMap;
+  delete[] myRAMReadMap;
+  delete[] myRAMWriteMap;
   delete[] myImage;
 }
 
@@ -82,6 +92,7 @@ void Cartridge3E::install(System& system)
     access.directPeekBase = 0;
     access.directPokeBase = 0;
     access.device = this;
+    access.type = System::PageHotspot;
     mySystem->setPageAccess(i >> shift, access);
   }
 
@@ -91,13 +102,49 @@ void Cartridge3E::install(System& system)
     access.device = this;
     access.directPeekBase = &myImage[(mySize - 2048) + (j & 0x07FF)];
     access.directPokeBase = 0;
+    access.type = System::PageROM;
     mySystem->setPageAccess(j >> shift, access);
   }
 
+  // Build the page accesses of every ROM and RAM bank, so a bank switch
+  // is a copy
+  myBankMap = createBankMap(0x1000, 0x1800, myImage, 0, 2048, mySize / 2048,
+      System::PageROM);
+  myRAMReadMap = createBankMap(0x1000, 0x1400, myRam, 0, 1024, 32,
+      System::PageRAM);
+  myRAMWriteMap = createBankMap(0x1400, 0x1800, 0, myRam, 1024, 32,
+      System::PageRAM);
+
   // Install pages for bank 0 into the first segment
   bank(0);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Cartridge3E::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putShort(myCurrentBank);
+  out.putBytes(myRam, sizeof(myRam));
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Cartridge3E::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  uInt16 bank = in.getShort();
+  in.getBytes(myRam, sizeof(myRam));
+
+  // Bank numbers of 256 and up select one of the RAM banks
+  this->bank(bank);
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 Cartridge3E::peek(uInt16 address)
 {
@@ -139,6 +186,12 @@ void Cartridge3E::poke(uInt16 address, uInt8 value)
   //mySystem->tia().poke(address, value);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 Cartridge3E::currentBank(uInt16 address) const
+{
+  return (address & 0x0800) ? (mySize >> 11) - 1 : myCurrentBank;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Cartridge3E::bank(uInt16 bank)
 { 
@@ -158,20 +211,8 @@ void Cartridge3E::bank(uInt16 bank)
       myCurrentBank = bank % (mySize / 2048);
     }
   
-    uInt32 offset = myCurrentBank * 2048;
-    uInt16 shift = mySystem->pageShift();
-  
-    // Setup the page access methods for the current bank
-    System::PageAccess access;
-    access.device = this;
-    access.directPokeBase = 0;
-  
     // Map ROM image into the system
-    for(uInt32 address = 0x1000; address < 0x1800; address += (1 << shift))
-    {
-      access.directPeekBase = &myImage[offset + (address & 0x07FF)];
-      mySystem->setPageAccess(address >> shift, access);
-    }
+    installBank(myBankMap, 0x1000, 0x1800, myCurrentBank);
   }
   else
   {
@@ -179,29 +220,8 @@ void Cartridge3E::bank(uInt16 bank)
     bank %= 32;
     myCurrentBank = bank + 256;
 
-    uInt32 offset = bank * 1024;
-    uInt16 shift = mySystem->pageShift();
-    uInt32 address;
-  
-    // Setup the page access methods for the current bank
-    System::PageAccess access;
-    access.device = this;
-    access.directPokeBase = 0;
-  
-    // Map read-port RAM image into the system
-    for(address = 0x1000; address < 0x1400; address += (1 << shift))
-    {
-      access.directPeekBase = &myRam[offset + (address & 0x03FF)];
-      mySystem->setPageAccess(address >> shift, access);
-    }
-
-    access.directPeekBase = 0;
-
-    // Map write-port RAM image into the system
-    for(address = 0x1400; address < 0x1800; address += (1 << shift))
-    {
-      access.directPokeBase = &myRam[offset + (address & 0x03FF)];
-      mySystem->setPageAccess(address >> shift, access);
-    }
+    // Map read-port and write-port RAM image into the system
+    installBank(myRAMReadMap, 0x1000, 0x1400, bank);
+    installBank(myRAMWriteMap, 0x1400, 0x1800, bank);
   }
 }
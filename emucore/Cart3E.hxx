@@ -96,6 +96,22 @@ class Cartridge3E : public Cartridge
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
   public:
     /**
       Get the byte at the specified address
@@ -112,6 +128,14 @@ class Cartridge3E : public Cartridge
     */
     virtual void poke(uInt16 address, uInt8 value);
 
+    /**
+      Get the bank mapped at the specified address
+
+      @param address An address in the cartridge's space
+      @return The bank the address reads from
+    */
+    virtual uInt16 currentBank(uInt16 address) const;
+
   private:
     /** 
       Map the specified bank into the first segment
@@ -132,6 +156,13 @@ class Cartridge3E : public Cartridge
     
     // Size of the ROM image
     uInt32 mySize;
+
+    // Page accesses of every ROM bank, bank after bank
+    System::PageAccess* myBankMap;
+
+    // Page accesses of the read and write ports of every RAM bank
+    System::PageAccess* myRAMReadMap;
+    System::PageAccess* myRAMWriteMap;
 };
 #endif
 
@@ -19,6 +19,8 @@
 #include <assert.h>
 #include "Cart3F.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -33,11 +35,15 @@ Cartridge3F::Cartridge3F(const uInt8* image, uInt32 size)
   {
     myImage[addr] = image[addr];
   }
+
+  // The page accesses of the banks are built by install
+  myBankMap = 0;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Cartridge3F::~Cartridge3F()
 {
+  delete[] myBankMap;
   delete[] myImage;
 }
 
@@ -73,6 +79,7 @@ void Cartridge3F::install(System& system)
     access.directPeekBase = 0;
     access.directPokeBase = 0;
     access.device = this;
+    access.type = System::PageHotspot;
     mySystem->setPageAccess(i >> shift, access);
   }
 
@@ -82,13 +89,39 @@ void Cartridge3F::install(System& system)
     access.device = this;
     access.directPeekBase = &myImage[(mySize - 2048) + (j & 0x07FF)];
     access.directPokeBase = 0;
+    access.type = System::PageROM;
     mySystem->setPageAccess(j >> shift, access);
   }
 
+  // Build the page accesses of every bank, so a bank switch is a copy
+  myBankMap = createBankMap(0x1000, 0x1800, myImage, 0, 2048, mySize / 2048,
+      System::PageROM);
+
   // Install pages for bank 0 into the first segment
   bank(0);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Cartridge3F::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putShort(myCurrentBank);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Cartridge3F::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  bank(in.getShort());
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 Cartridge3F::peek(uInt16 address)
 {
@@ -116,6 +149,12 @@ void Cartridge3F::poke(uInt16 address, uInt8 value)
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 Cartridge3F::currentBank(uInt16 address) const
+{
+  return (address & 0x0800) ? (mySize >> 11) - 1 : myCurrentBank;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Cartridge3F::bank(uInt16 bank)
 { 
@@ -131,18 +170,6 @@ void Cartridge3F::bank(uInt16 bank)
     myCurrentBank = bank % (mySize / 2048);
   }
 
-  uInt32 offset = myCurrentBank * 2048;
-  uInt16 shift = mySystem->pageShift();
-
-  // Setup the page access methods for the current bank
-  System::PageAccess access;
-  access.device = this;
-  access.directPokeBase = 0;
-
   // Map ROM image into the system
-  for(uInt32 address = 0x1000; address < 0x1800; address += (1 << shift))
-  {
-    access.directPeekBase = &myImage[offset + (address & 0x07FF)];
-    mySystem->setPageAccess(address >> shift, access);
-  }
+  installBank(myBankMap, 0x1000, 0x1800, myCurrentBank);
 }
@@ -22,6 +22,8 @@
 #include "M6502Hi.hxx"
 #include "Random.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -40,6 +42,10 @@ CartridgeAR::CartridgeAR(const uInt8* image, uInt32 size)
   if(size < 8448)
     memcpy(myLoadImages+8192, ourDefaultHeader, 256);
 
+  // No write is pending until the first access to the data hold register
+  myWriteEnabled = false;
+  myWritePending = false;
+
   // Initialize RAM with random values
   /*Random random;
   for(i = 0; i < 6 * 1024; ++i)
@@ -103,26 +109,57 @@ void CartridgeAR::systemCyclesReset()
 void CartridgeAR::install(System& system)
 {
   mySystem = &system;
-  uInt16 shift = mySystem->pageShift();
   uInt16 mask = mySystem->pageMask();
 
   my6502 = &(M6502High&)mySystem->m6502();
 
   // Make sure the system we're being installed in has a page size that'll work
-  assert((0x1000 & mask) == 0);
-
-  System::PageAccess access;
-  for(uInt32 i = 0x1000; i < 0x2000; i += (1 << shift))
-  {
-    access.directPeekBase = 0;
-    access.directPokeBase = 0;
-    access.device = this;
-    mySystem->setPageAccess(i >> shift, access);
-  }
+  assert(((0x1000 & mask) == 0) && ((0x1100 & mask) == 0));
 
   bankConfiguration(0);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeAR::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putInt(myImageOffset[0]);
+  out.putInt(myImageOffset[1]);
+  out.putBytes(myImage, sizeof(myImage));
+  out.putBytes(myHeader, sizeof(myHeader));
+  out.putBool(myWriteEnabled);
+  out.putBool(myPower);
+  out.putInt(myPowerRomCycle);
+  out.putByte(myDataHoldRegister);
+  out.putInt(myNumberOfDistinctAccesses);
+  out.putBool(myWritePending);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeAR::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  myImageOffset[0] = in.getInt();
+  myImageOffset[1] = in.getInt();
+  in.getBytes(myImage, sizeof(myImage));
+  in.getBytes(myHeader, sizeof(myHeader));
+  myWriteEnabled = in.getBool();
+  myPower = in.getBool();
+  myPowerRomCycle = (Int32)in.getInt();
+  myDataHoldRegister = in.getByte();
+  myNumberOfDistinctAccesses = in.getInt();
+  myWritePending = in.getBool();
+
+  mapPages();
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 CartridgeAR::peek(uInt16 addr)
 {
@@ -171,6 +208,11 @@ uInt8 CartridgeAR::peek(uInt16 addr)
     myWritePending = false;
   }
 
+  if(myPagesDirect == (myWriteEnabled && myWritePending))
+  {
+    mapPages();
+  }
+
   return myImage[(addr & 0x07FF) + myImageOffset[(addr & 0x0800) ? 1 : 0]];
 }
 
@@ -209,6 +251,17 @@ void CartridgeAR::poke(uInt16 addr, uInt8)
       myImage[(addr & 0x07FF) + myImageOffset[1]] = myDataHoldRegister;
     myWritePending = false;
   }
+
+  if(myPagesDirect == (myWriteEnabled && myWritePending))
+  {
+    mapPages();
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 CartridgeAR::currentBank(uInt16 address) const
+{
+  return myImageOffset[(address & 0x0800) ? 1 : 0] >> 11;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -300,6 +353,44 @@ void CartridgeAR::bankConfiguration(uInt8 configuration)
       break;
     }
   }
+
+  mapPages();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void CartridgeAR::mapPages()
+{
+  uInt16 shift = mySystem->pageShift();
+  uInt16 mask = mySystem->pageMask();
+
+  // While a write is pending any access may be the one that makes it
+  myPagesDirect = !(myWriteEnabled && myWritePending);
+
+  System::PageAccess access;
+  access.device = this;
+  access.directPokeBase = 0;
+
+  for(uInt32 address = 0x1000; address < 0x2000; address += (1 << shift))
+  {
+    // Accesses to $F000-$F0FF load the data hold register, $FFF8 changes
+    // the bank configuration and the BIOS reads a load at $F850
+    bool hotspot = (address < 0x1100) || (address == (0x1FF8U & ~mask)) ||
+        ((address == (0x1850U & ~mask)) && (myImageOffset[1] == 3 * 2048));
+
+    if(myPagesDirect && !hotspot)
+    {
+      // The RAM can change under any page, so none of them is ROM
+      access.directPeekBase = &myImage[(address & 0x07FF) +
+          myImageOffset[(address & 0x0800) ? 1 : 0]];
+      access.type = System::PageRAM;
+    }
+    else
+    {
+      access.directPeekBase = 0;
+      access.type = System::PageDevice;
+    }
+    mySystem->setPageAccess(address >> shift, access);
+  }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
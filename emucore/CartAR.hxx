@@ -81,6 +81,22 @@ class CartridgeAR : public Cartridge
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
     /**
       Install pages for the specified bank in the system.
 
@@ -131,6 +147,14 @@ class CartridgeAR : public Cartridge
     */
     virtual void poke(uInt16 address, uInt8 value);
 
+    /**
+      Get the bank mapped at the specified address
+
+      @param address An address in the cartridge's space
+      @return The bank the address reads from
+    */
+    virtual uInt16 currentBank(uInt16 address) const;
+
   private:
     /**
       Query/change the given address type to use the given disassembly flags
@@ -144,6 +168,10 @@ class CartridgeAR : public Cartridge
     // Handle a change to the bank configuration
     void bankConfiguration(uInt8 configuration);
 
+    // Install the pages for the bank configuration, mapping the banks
+    // directly unless a write is pending
+    void mapPages();
+
     // Compute the sum of the array of bytes
     uInt8 checksum(uInt8* s, uInt16 length);
 
@@ -193,6 +221,10 @@ class CartridgeAR : public Cartridge
     // Indicates if a write is pending or not
     bool myWritePending;
 
+    // Indicates if the pages are mapped directly, which they are unless
+    // a write is pending
+    bool myPagesDirect;
+
     uInt16 myCurrentBank;
 
     // Fake SC-BIOS code to simulate the Supercharger load bars
@@ -20,6 +20,8 @@
 #include "CartCV.hxx"
 #include "Random.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -95,6 +97,7 @@ void CartridgeCV::install(System& system)
   for(uInt32 address = 0x1800; address < 0x2000; address += (1 << shift))
   {
     access.directPeekBase = &myImage[address & 0x07FF];
+    access.type = System::PageROM;
     mySystem->setPageAccess(address >> mySystem->pageShift(), access);
   }
 
@@ -104,6 +107,7 @@ void CartridgeCV::install(System& system)
     access.device = this;
     access.directPeekBase = 0;
     access.directPokeBase = &myRAM[j & 0x03FF];
+    access.type = System::PageRAM;
     mySystem->setPageAccess(j >> shift, access);
   }
 
@@ -113,10 +117,32 @@ void CartridgeCV::install(System& system)
     access.device = this;
     access.directPeekBase = &myRAM[k & 0x03FF];
     access.directPokeBase = 0;
+    access.type = System::PageRAM;
     mySystem->setPageAccess(k >> shift, access);
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeCV::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putBytes(myRAM, sizeof(myRAM));
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeCV::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  in.getBytes(myRAM, sizeof(myRAM));
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 CartridgeCV::peek(uInt16 address)
 {
@@ -20,6 +20,27 @@
 #include <iostream>
 #include "CartDPC.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
+
+uInt8 CartridgeDPC::ourRandomSequence[255];
+uInt8 CartridgeDPC::ourRandomPositions[256];
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static uInt8 nextRandomNumber(uInt8 value)
+{
+  // Table for computing the input bit of the random number generator's
+  // shift register (it's the NOT of the EOR of four bits)
+  static const uInt8 f[16] = {
+    1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1
+  };
+
+  // Using bits 7, 5, 4, & 3 of the shift register compute the input
+  // bit for the shift register
+  uInt8 bit = f[((value >> 3) & 0x07) | ((value & 0x80) ? 0x08 : 0x00)];
+
+  return (value << 1) | bit;
+}
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeDPC::CartridgeDPC(const uInt8* image, uInt32 size)
@@ -49,15 +70,33 @@ CartridgeDPC::CartridgeDPC(const uInt8* image, uInt32 size)
 
   // Initialize the DPC's random number generator register (must be non-zero)
   myRandomNumber = 1;
+  myRandomClocks = 0;
+
+  // Lay out the random number generator's cycle the first time through
+  if(ourRandomPositions[0xFF] == 0)
+  {
+    uInt8 value = 1;
+    for(uInt32 i = 0; i < 255; ++i)
+    {
+      ourRandomSequence[i] = value;
+      ourRandomPositions[value] = i;
+      value = nextRandomNumber(value);
+    }
+    ourRandomPositions[0xFF] = 0xFF;
+  }
 
   // Initialize the system cycles counter & fractional clock values
   mySystemCycles = 0;
-  myFractionalClocks = 0.0;
+  myFractionalClocks = 0;
+
+  // The page accesses of the banks are built by install
+  myBankMap = 0;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeDPC::~CartridgeDPC()
 {
+  delete[] myBankMap;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -71,7 +110,7 @@ void CartridgeDPC::reset()
 {
   // Update cycles to the current system cycles
   mySystemCycles = mySystem->cycles();
-  myFractionalClocks = 0.0;
+  myFractionalClocks = 0;
 
   // Upon reset we switch to bank 1
   bank(1);
@@ -85,6 +124,10 @@ void CartridgeDPC::systemCyclesReset()
 
   // Adjust the cycle counter so that it reflects the new value
   mySystemCycles -= cycles;
+
+  // Apply the random number generator's clocks once a frame so the
+  // count can't overflow
+  updateRandomNumberGenerator();
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -104,6 +147,7 @@ void CartridgeDPC::install(System& system)
     access.directPeekBase = 0;
     access.directPokeBase = 0;
     access.device = this;
+    access.type = System::PageHotspot;
     mySystem->setPageAccess(i >> shift, access);
   }
 
@@ -113,29 +157,90 @@ void CartridgeDPC::install(System& system)
     access.directPeekBase = 0;
     access.directPokeBase = 0;
     access.device = this;
+    access.type = System::PageDevice;
     mySystem->setPageAccess(j >> shift, access);
   }
 
+  // Build the page accesses of every bank, so a bank switch is a copy
+  myBankMap = createBankMap(0x1080, 0x1FF8U & ~mask, &myProgramImage[0x0080],
+      0, 4096, 2, System::PageROM);
+
   // Install pages for bank 1
   bank(1);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-inline void CartridgeDPC::clockRandomNumberGenerator()
+bool CartridgeDPC::save(Serializer& out)
 {
-  // Table for computing the input bit of the random number generator's
-  // shift register (it's the NOT of the EOR of four bits)
-  static const uInt8 f[16] = {
-    1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1
-  };
+  out.putString(name());
 
-  // Using bits 7, 5, 4, & 3 of the shift register compute the input
-  // bit for the shift register
-  uInt8 bit = f[((myRandomNumber >> 3) & 0x07) | 
-      ((myRandomNumber & 0x80) ? 0x08 : 0x00)];
+  out.putShort(myCurrentBank);
 
-  // Update the shift register 
-  myRandomNumber = (myRandomNumber << 1) | bit;
+  // The data fetcher registers
+  out.putBytes(myTops, sizeof(myTops));
+  out.putBytes(myBottoms, sizeof(myBottoms));
+  for(uInt32 i = 0; i < 8; ++i)
+    out.putShort(myCounters[i]);
+  out.putBytes(myFlags, sizeof(myFlags));
+
+  for(uInt32 j = 0; j < 3; ++j)
+    out.putBool(myMusicMode[j]);
+
+  updateRandomNumberGenerator();
+  out.putByte(myRandomNumber);
+  out.putInt(mySystemCycles);
+  out.putInt(myFractionalClocks);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeDPC::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  uInt16 bank = in.getShort();
+
+  // The data fetcher registers
+  in.getBytes(myTops, sizeof(myTops));
+  in.getBytes(myBottoms, sizeof(myBottoms));
+  for(uInt32 i = 0; i < 8; ++i)
+    myCounters[i] = in.getShort();
+  in.getBytes(myFlags, sizeof(myFlags));
+
+  for(uInt32 j = 0; j < 3; ++j)
+    myMusicMode[j] = in.getBool();
+
+  myRandomNumber = in.getByte();
+  myRandomClocks = 0;
+  mySystemCycles = (Int32)in.getInt();
+  myFractionalClocks = in.getInt();
+
+  this->bank(bank);
+
+  return in.isValid();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inline void CartridgeDPC::clockRandomNumberGenerator()
+{
+  // The clocks are only counted here, the register is brought up to date
+  // when it's read
+  ++myRandomClocks;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void CartridgeDPC::updateRandomNumberGenerator()
+{
+  // Every state but $FF is on the same cycle of 255 states, so any number
+  // of clocks is a single step along the cycle
+  uInt32 position = ourRandomPositions[myRandomNumber];
+  if(position != 0xFF)
+  {
+    myRandomNumber = ourRandomSequence[(position + myRandomClocks % 255) % 255];
+  }
+  myRandomClocks = 0;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -145,10 +250,18 @@ inline void CartridgeDPC::updateMusicModeDataFetchers()
   Int32 cycles = mySystem->cycles() - mySystemCycles;
   mySystemCycles = mySystem->cycles();
 
-  // Calculate the number of DPC OSC clocks since the last update
-  double clocks = ((15750.0 * cycles) / 1193191.66666667) + myFractionalClocks;
-  Int32 wholeClocks = (Int32)clocks;
-  myFractionalClocks = clocks - (double)wholeClocks;
+  if(cycles <= 0)
+  {
+    return;
+  }
+
+  // Calculate the number of DPC OSC clocks since the last update.  The
+  // 15750Hz OSC is exactly 1890/143183 of the 1193191.67Hz system clock,
+  // so the clocks are counted in whole numbers of 143183ths
+  uInt32 blocks = (uInt32)cycles / 143183;
+  uInt32 clocks = ((uInt32)cycles % 143183) * 1890 + myFractionalClocks;
+  Int32 wholeClocks = blocks * 1890 + clocks / 143183;
+  myFractionalClocks = clocks % 143183;
 
   if(wholeClocks <= 0)
   {
@@ -227,6 +340,7 @@ uInt8 CartridgeDPC::peek(uInt16 address)
         // Is this a random number read
         if(index < 4)
         {
+          updateRandomNumberGenerator();
           result = myRandomNumber;
         }
         // No, it's a music read
@@ -390,6 +504,7 @@ void CartridgeDPC::poke(uInt16 address, uInt8 value)
       case 0x06:
       {
         myRandomNumber = 1;
+        myRandomClocks = 0;
         break;
       }
 
@@ -420,25 +535,19 @@ void CartridgeDPC::poke(uInt16 address, uInt8 value)
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 CartridgeDPC::currentBank(uInt16) const
+{
+  return myCurrentBank;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void CartridgeDPC::bank(uInt16 bank)
 { 
   // Remember what bank we're in
   myCurrentBank = bank;
-  uInt16 offset = myCurrentBank * 4096;
-  uInt16 shift = mySystem->pageShift();
   uInt16 mask = mySystem->pageMask();
 
-  // Setup the page access methods for the current bank
-  System::PageAccess access;
-  access.device = this;
-  access.directPokeBase = 0;
-
   // Map Program ROM image into the system
-  for(uInt32 address = 0x1080; address < (0x1FF8U & ~mask);
-      address += (1 << shift))
-  {
-    access.directPeekBase = &myProgramImage[offset + (address & 0x0FFF)];
-    mySystem->setPageAccess(address >> shift, access);
-  }
+  installBank(myBankMap, 0x1080, 0x1FF8U & ~mask, myCurrentBank);
 }
@@ -75,6 +75,22 @@ class CartridgeDPC : public Cartridge
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
   public:
     /**
       Get the byte at the specified address.
@@ -91,6 +107,14 @@ class CartridgeDPC : public Cartridge
     */
     virtual void poke(uInt16 address, uInt8 value);
 
+    /**
+      Get the bank mapped at the specified address
+
+      @param address An address in the cartridge's space
+      @return The bank the address reads from
+    */
+    virtual uInt16 currentBank(uInt16 address) const;
+
   private:
     /**
       Install pages for the specified bank in the system
@@ -104,6 +128,12 @@ class CartridgeDPC : public Cartridge
     */
     void clockRandomNumberGenerator();
 
+    /** 
+      Applies the clocks counted since the last update to the random
+      number generator's register
+    */
+    void updateRandomNumberGenerator();
+
     /** 
       Updates any data fetchers in music mode based on the number of
       CPU cycles which have passed since the last update.
@@ -138,11 +168,26 @@ class CartridgeDPC : public Cartridge
     // The random number generator register
     uInt8 myRandomNumber;
 
+    // Clocks of the random number generator not yet applied to its register
+    uInt32 myRandomClocks;
+
     // System cycle count when the last update to music data fetchers occurred
     Int32 mySystemCycles;
 
-    // Fractional DPC music OSC clocks unused during the last update
-    double myFractionalClocks;
+    // Fractional DPC music OSC clocks unused during the last update,
+    // in 143183ths of a clock
+    uInt32 myFractionalClocks;
+
+    // Page accesses of every bank, bank after bank
+    System::PageAccess* myBankMap;
+
+  private:
+    // The states of the random number generator in the order it steps
+    // through them, starting from 1 ($FF is left out, it never changes)
+    static uInt8 ourRandomSequence[255];
+
+    // The index of each state in ourRandomSequence ($FF for $FF)
+    static uInt8 ourRandomPositions[256];
 };
 #endif
 
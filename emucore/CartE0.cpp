@@ -19,6 +19,8 @@
 #include <assert.h>
 #include "CartE0.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -29,11 +31,21 @@ CartridgeE0::CartridgeE0(const uInt8* image)
   {
     myImage[addr] = image[addr];
   }
+
+  // The page accesses of the slices are built by install
+  for(uInt32 i = 0; i < 3; ++i)
+  {
+    mySegmentMap[i] = 0;
+  }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeE0::~CartridgeE0()
 {
+  for(uInt32 i = 0; i < 3; ++i)
+  {
+    delete[] mySegmentMap[i];
+  }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -69,6 +81,7 @@ void CartridgeE0::install(System& system)
   for(uInt32 i = 0x1C00; i < (0x1FE0U & ~mask); i += (1 << shift))
   {
     access.directPeekBase = &myImage[7168 + (i & 0x03FF)];
+    access.type = System::PageROM;
     mySystem->setPageAccess(i >> shift, access);
   }
   myCurrentSlice[3] = 7;
@@ -79,15 +92,48 @@ void CartridgeE0::install(System& system)
   access.device = this;
   for(uInt32 j = (0x1FE0 & ~mask); j < 0x2000; j += (1 << shift))
   {
+    access.type = System::PageHotspot;
     mySystem->setPageAccess(j >> shift, access);
   }
 
+  // Build the page accesses of every slice for the other segments, so a
+  // bank switch is a copy
+  for(uInt32 k = 0; k < 3; ++k)
+  {
+    mySegmentMap[k] = createBankMap(0x1000 + (k << 10), 0x1400 + (k << 10),
+        myImage, 0, 1024, 8, System::PageROM);
+  }
+
   // Install some default slices for the other segments
   segmentZero(4);
   segmentOne(5);
   segmentTwo(6);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeE0::save(Serializer& out)
+{
+  out.putString(name());
+
+  for(uInt32 i = 0; i < 3; ++i)
+    out.putShort(myCurrentSlice[i]);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeE0::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  segmentZero(in.getShort());
+  segmentOne(in.getShort());
+  segmentTwo(in.getShort());
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 CartridgeE0::peek(uInt16 address)
 {
@@ -130,24 +176,19 @@ void CartridgeE0::poke(uInt16 address, uInt8)
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 CartridgeE0::currentBank(uInt16 address) const
+{
+  return myCurrentSlice[(address & 0x0C00) >> 10];
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void CartridgeE0::segmentZero(uInt16 slice)
 { 
   // Remember the new slice
   myCurrentSlice[0] = slice;
-  uInt16 offset = slice << 10;
-  uInt16 shift = mySystem->pageShift();
-
-  // Setup the page access methods for the current bank
-  System::PageAccess access;
-  access.device = this;
-  access.directPokeBase = 0;
 
-  for(uInt32 address = 0x1000; address < 0x1400; address += (1 << shift))
-  {
-    access.directPeekBase = &myImage[offset + (address & 0x03FF)];
-    mySystem->setPageAccess(address >> shift, access);
-  }
+  installBank(mySegmentMap[0], 0x1000, 0x1400, slice);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -155,19 +196,8 @@ void CartridgeE0::segmentOne(uInt16 slice)
 { 
   // Remember the new slice
   myCurrentSlice[1] = slice;
-  uInt16 offset = slice << 10;
-  uInt16 shift = mySystem->pageShift();
-
-  // Setup the page access methods for the current bank
-  System::PageAccess access;
-  access.device = this;
-  access.directPokeBase = 0;
 
-  for(uInt32 address = 0x1400; address < 0x1800; address += (1 << shift))
-  {
-    access.directPeekBase = &myImage[offset + (address & 0x03FF)];
-    mySystem->setPageAccess(address >> shift, access);
-  }
+  installBank(mySegmentMap[1], 0x1400, 0x1800, slice);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -175,17 +205,6 @@ void CartridgeE0::segmentTwo(uInt16 slice)
 { 
   // Remember the new slice
   myCurrentSlice[2] = slice;
-  uInt16 offset = slice << 10;
-  uInt16 shift = mySystem->pageShift();
 
-  // Setup the page access methods for the current bank
-  System::PageAccess access;
-  access.device = this;
-  access.directPokeBase = 0;
-
-  for(uInt32 address = 0x1800; address < 0x1C00; address += (1 << shift))
-  {
-    access.directPeekBase = &myImage[offset + (address & 0x03FF)];
-    mySystem->setPageAccess(address >> shift, access);
-  }
+  installBank(mySegmentMap[2], 0x1800, 0x1C00, slice);
 }
@@ -72,6 +72,22 @@ class CartridgeE0 : public Cartridge
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
   public:
     /**
       Get the byte at the specified address.
@@ -88,6 +104,14 @@ class CartridgeE0 : public Cartridge
     */
     virtual void poke(uInt16 address, uInt8 value);
 
+    /**
+      Get the bank mapped at the specified address
+
+      @param address An address in the cartridge's space
+      @return The bank the address reads from
+    */
+    virtual uInt16 currentBank(uInt16 address) const;
+
   private:
     /**
       Install the specified slice for segment zero
@@ -116,6 +140,9 @@ class CartridgeE0 : public Cartridge
 
     // The 8K ROM image of the cartridge
     uInt8 myImage[8192];
+
+    // Page accesses of every slice for each of the first three segments
+    System::PageAccess* mySegmentMap[3];
 };
 #endif
 
@@ -20,6 +20,8 @@
 #include "CartE7.hxx"
 #include "Random.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -37,11 +39,21 @@ CartridgeE7::CartridgeE7(const uInt8* image)
   {
     myRAM[i] = random.next();
   }
+
+  // The page accesses of the banks are built by install
+  myBankMap = 0;
+  myRAMReadMap = myRAMWriteMap = 0;
+  myRAMBankReadMap = myRAMBankWriteMap = 0;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeE7::~CartridgeE7()
 {
+  delete[] myBankMap;
+  delete[] myRAMReadMap;
+  delete[] myRAMWriteMap;
+  delete[] myRAMBankReadMap;
+  delete[] myRAMBankWriteMap;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -76,6 +88,7 @@ void CartridgeE7::install(System& system)
     access.directPeekBase = 0;
     access.directPokeBase = 0;
     access.device = this;
+    access.type = System::PageHotspot;
     mySystem->setPageAccess(i >> shift, access);
   }
 
@@ -85,15 +98,57 @@ void CartridgeE7::install(System& system)
     access.device = this;
     access.directPeekBase = &myImage[7 * 2048 + (j & 0x07FF)];
     access.directPokeBase = 0;
+    access.type = System::PageROM;
     mySystem->setPageAccess(j >> shift, access);
   }
   myCurrentSlice[1] = 7;
 
+  // Build the page accesses of every ROM slice and RAM bank, so a bank
+  // switch is a copy
+  myBankMap = createBankMap(0x1000, 0x1800, myImage, 0, 2048, 7,
+      System::PageROM);
+  myRAMWriteMap = createBankMap(0x1000, 0x1400, 0, myRAM, 1024, 1,
+      System::PageRAM);
+  myRAMReadMap = createBankMap(0x1400, 0x1800, myRAM, 0, 1024, 1,
+      System::PageRAM);
+  myRAMBankWriteMap = createBankMap(0x1800, 0x1900, 0, &myRAM[1024], 256, 4,
+      System::PageRAM);
+  myRAMBankReadMap = createBankMap(0x1900, 0x1A00, &myRAM[1024], 0, 256, 4,
+      System::PageRAM);
+
   // Install some default banks for the RAM and first segment
   bankRAM(0);
   bank(0);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeE7::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putShort(myCurrentSlice[0]);
+  out.putShort(myCurrentRAM);
+  out.putBytes(myRAM, sizeof(myRAM));
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeE7::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  uInt16 slice = in.getShort();
+  uInt16 ram = in.getShort();
+  in.getBytes(myRAM, sizeof(myRAM));
+
+  bankRAM(ram);
+  bank(slice);
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 CartridgeE7::peek(uInt16 address)
 {
@@ -135,50 +190,28 @@ void CartridgeE7::poke(uInt16 address, uInt8)
   // way page accessing has been setup
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 CartridgeE7::currentBank(uInt16 address) const
+{
+  return myCurrentSlice[(address & 0x0800) ? 1 : 0];
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void CartridgeE7::bank(uInt16 slice)
 { 
   // Remember what bank we're in
   myCurrentSlice[0] = slice;
-  uInt16 offset = slice << 11;
-  uInt16 shift = mySystem->pageShift();
 
-  // Setup the page access methods for the current bank
   if(slice != 7)
   {
-    System::PageAccess access;
-    access.device = this;
-    access.directPokeBase = 0;
-
     // Map ROM image into first segment
-    for(uInt32 address = 0x1000; address < 0x1800; address += (1 << shift))
-    {
-      access.directPeekBase = &myImage[offset + (address & 0x07FF)];
-      mySystem->setPageAccess(address >> shift, access);
-    }
+    installBank(myBankMap, 0x1000, 0x1800, slice);
   }
   else
   {
-    System::PageAccess access;
-    access.device = this;
-
-    // Set the page accessing method for the 1K slice of RAM writing pages
-    access.directPeekBase = 0;
-    access.directPokeBase = 0;
-    for(uInt32 j = 0x1000; j < 0x1400; j += (1 << shift))
-    {
-      access.directPokeBase = &myRAM[j & 0x03FF];
-      mySystem->setPageAccess(j >> shift, access);
-    }
-
-    // Set the page accessing method for the 1K slice of RAM reading pages
-    access.directPeekBase = 0;
-    access.directPokeBase = 0;
-    for(uInt32 k = 0x1400; k < 0x1800; k += (1 << shift))
-    {
-      access.directPeekBase = &myRAM[k & 0x03FF];
-      mySystem->setPageAccess(k >> shift, access);
-    }
+    // Map the 1K slice of RAM writing and reading pages
+    installBank(myRAMWriteMap, 0x1000, 0x1400, 0);
+    installBank(myRAMReadMap, 0x1400, 0x1800, 0);
   }
 }
 
@@ -187,28 +220,8 @@ void CartridgeE7::bankRAM(uInt16 bank)
 { 
   // Remember what bank we're in
   myCurrentRAM = bank;
-  uInt16 offset = bank << 8;
-  uInt16 shift = mySystem->pageShift();
-
-  // Setup the page access methods for the current bank
-  System::PageAccess access;
-  access.device = this;
 
-  // Set the page accessing method for the 256 bytes of RAM writing pages
-  access.directPeekBase = 0;
-  access.directPokeBase = 0;
-  for(uInt32 j = 0x1800; j < 0x1900; j += (1 << shift))
-  {
-    access.directPokeBase = &myRAM[1024 + offset + (j & 0x00FF)];
-    mySystem->setPageAccess(j >> shift, access);
-  }
-
-  // Set the page accessing method for the 256 bytes of RAM reading pages
-  access.directPeekBase = 0;
-  access.directPokeBase = 0;
-  for(uInt32 k = 0x1900; k < 0x1A00; k += (1 << shift))
-  {
-    access.directPeekBase = &myRAM[1024 + offset + (k & 0x00FF)];
-    mySystem->setPageAccess(k >> shift, access);
-  }
+  // Map the 256 bytes of RAM writing and reading pages
+  installBank(myRAMBankWriteMap, 0x1800, 0x1900, bank);
+  installBank(myRAMBankReadMap, 0x1900, 0x1A00, bank);
 }
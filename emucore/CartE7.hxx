@@ -89,6 +89,22 @@ class CartridgeE7 : public Cartridge
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
   public:
     /**
       Get the byte at the specified address.
@@ -105,6 +121,14 @@ class CartridgeE7 : public Cartridge
     */
     virtual void poke(uInt16 address, uInt8 value);
 
+    /**
+      Get the bank mapped at the specified address
+
+      @param address An address in the cartridge's space
+      @return The bank the address reads from
+    */
+    virtual uInt16 currentBank(uInt16 address) const;
+
   private:
     /**
       Map the specfied bank into the first segment
@@ -132,6 +156,17 @@ class CartridgeE7 : public Cartridge
 
     // The 2048 bytes of RAM
     uInt8 myRAM[2048];
+
+    // Page accesses of every ROM slice for the first segment
+    System::PageAccess* myBankMap;
+
+    // Page accesses of the 1K slice of RAM's read and write ports
+    System::PageAccess* myRAMReadMap;
+    System::PageAccess* myRAMWriteMap;
+
+    // Page accesses of the read and write ports of every 256 byte bank
+    System::PageAccess* myRAMBankReadMap;
+    System::PageAccess* myRAMBankWriteMap;
 };
 #endif
 
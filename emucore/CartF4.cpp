@@ -21,6 +21,8 @@
 #include "CartF4.hxx"
 #include "Random.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeF4::CartridgeF4(const uInt8* image)
@@ -30,11 +32,15 @@ CartridgeF4::CartridgeF4(const uInt8* image)
   {
     myImage[addr] = image[addr];
   }
+
+  // The page accesses of the banks are built by install
+  myBankMap = 0;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeF4::~CartridgeF4()
 {
+  delete[] myBankMap;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -67,13 +73,39 @@ void CartridgeF4::install(System& system)
     access.directPeekBase = 0;
     access.directPokeBase = 0;
     access.device = this;
+    access.type = System::PageHotspot;
     mySystem->setPageAccess(i >> shift, access);
   }
 
+  // Build the page accesses of every bank, so a bank switch is a copy
+  myBankMap = createBankMap(0x1000, 0x1FF4U & ~mask, myImage, 0, 4096, 8,
+      System::PageROM);
+
   // Install pages for bank 7
   bank(7);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeF4::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putShort(myCurrentBank);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeF4::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  bank(in.getShort());
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 CartridgeF4::peek(uInt16 address)
 {
@@ -100,27 +132,21 @@ void CartridgeF4::poke(uInt16 address, uInt8)
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 CartridgeF4::currentBank(uInt16) const
+{
+  return myCurrentBank;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void CartridgeF4::bank(uInt16 bank)
 { 
   // Remember what bank we're in
   myCurrentBank = bank;
-  uInt16 offset = myCurrentBank * 4096;
-  uInt16 shift = mySystem->pageShift();
   uInt16 mask = mySystem->pageMask();
 
-  // Setup the page access methods for the current bank
-  System::PageAccess access;
-  access.device = this;
-  access.directPokeBase = 0;
-
   // Map ROM image into the system
-  for(uInt32 address = 0x1000; address < (0x1FF4U & ~mask);
-      address += (1 << shift))
-  {
-    access.directPeekBase = &myImage[offset + (address & 0x0FFF)];
-    mySystem->setPageAccess(address >> shift, access);
-  }
+  installBank(myBankMap, 0x1000, 0x1FF4U & ~mask, myCurrentBank);
 }
 
 
@@ -67,6 +67,22 @@ class CartridgeF4SC : public Cartridge
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
   public:
     /**
       Get the byte at the specified address.
@@ -83,6 +99,14 @@ class CartridgeF4SC : public Cartridge
     */
     virtual void poke(uInt16 address, uInt8 value);
 
+    /**
+      Get the bank mapped at the specified address
+
+      @param address An address in the cartridge's space
+      @return The bank the address reads from
+    */
+    virtual uInt16 currentBank(uInt16 address) const;
+
   private:
     /**
       Install pages for the specified bank in the system
@@ -100,6 +124,9 @@ class CartridgeF4SC : public Cartridge
 
     // The 128 bytes of RAM
     uInt8 myRAM[128];
+
+    // Page accesses of every bank, bank after bank
+    System::PageAccess* myBankMap;
 };
 #endif
 
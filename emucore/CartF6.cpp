@@ -19,6 +19,8 @@
 #include <assert.h>
 #include "CartF6.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -29,11 +31,15 @@ CartridgeF6::CartridgeF6(const uInt8* image)
   {
     myImage[addr] = image[addr];
   }
+
+  // The page accesses of the banks are built by install
+  myBankMap = 0;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeF6::~CartridgeF6()
 {
+  delete[] myBankMap;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -66,13 +72,39 @@ void CartridgeF6::install(System& system)
     access.directPeekBase = 0;
     access.directPokeBase = 0;
     access.device = this;
+    access.type = System::PageHotspot;
     mySystem->setPageAccess(i >> shift, access);
   }
 
+  // Build the page accesses of every bank, so a bank switch is a copy
+  myBankMap = createBankMap(0x1000, 0x1FF6U & ~mask, myImage, 0, 4096, 4,
+      System::PageROM);
+
   // Upon install we'll setup bank 0
   bank(0);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeF6::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putShort(myCurrentBank);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeF6::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  bank(in.getShort());
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 CartridgeF6::peek(uInt16 address)
 {
@@ -141,26 +173,20 @@ void CartridgeF6::poke(uInt16 address, uInt8)
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 CartridgeF6::currentBank(uInt16) const
+{
+  return myCurrentBank;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void CartridgeF6::bank(uInt16 bank)
 { 
   // Remember what bank we're in
   myCurrentBank = bank;
-  uInt16 offset = myCurrentBank * 4096;
-  uInt16 shift = mySystem->pageShift();
   uInt16 mask = mySystem->pageMask();
 
-  // Setup the page access methods for the current bank
-  System::PageAccess access;
-  access.device = this;
-  access.directPokeBase = 0;
-
   // Map ROM image into the system
-  for(uInt32 address = 0x1000; address < (0x1FF6U & ~mask);
-      address += (1 << shift))
-  {
-    access.directPeekBase = &myImage[offset + (address & 0x0FFF)];
-    mySystem->setPageAccess(address >> shift, access);
-  }
+  installBank(myBankMap, 0x1000, 0x1FF6U & ~mask, myCurrentBank);
 }
 
@@ -20,6 +20,8 @@
 #include "CartF8SC.hxx"
 #include "Random.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -37,11 +39,15 @@ CartridgeF8SC::CartridgeF8SC(const uInt8* image)
   {
     myRAM[i] = random.next();
   }
+
+  // The page accesses of the banks are built by install
+  myBankMap = 0;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeF8SC::~CartridgeF8SC()
 {
+  delete[] myBankMap;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -74,6 +80,7 @@ void CartridgeF8SC::install(System& system)
     access.directPeekBase = 0;
     access.directPokeBase = 0;
     access.device = this;
+    access.type = System::PageHotspot;
     mySystem->setPageAccess(i >> shift, access);
   }
 
@@ -83,6 +90,7 @@ void CartridgeF8SC::install(System& system)
     access.device = this;
     access.directPeekBase = 0;
     access.directPokeBase = &myRAM[j & 0x007F];
+    access.type = System::PageRAM;
     mySystem->setPageAccess(j >> shift, access);
   }
  
@@ -92,13 +100,42 @@ void CartridgeF8SC::install(System& system)
     access.device = this;
     access.directPeekBase = &myRAM[k & 0x007F];
     access.directPokeBase = 0;
+    access.type = System::PageRAM;
     mySystem->setPageAccess(k >> shift, access);
   }
 
+  // Build the page accesses of every bank, so a bank switch is a copy
+  myBankMap = createBankMap(0x1100, 0x1FF8U & ~mask, &myImage[0x0100], 0,
+      4096, 2, System::PageROM);
+
   // Install pages for bank 1
   bank(1);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeF8SC::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putShort(myCurrentBank);
+  out.putBytes(myRAM, sizeof(myRAM));
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeF8SC::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  uInt16 bank = in.getShort();
+  in.getBytes(myRAM, sizeof(myRAM));
+  this->bank(bank);
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 CartridgeF8SC::peek(uInt16 address)
 {
@@ -154,25 +191,19 @@ void CartridgeF8SC::poke(uInt16 address, uInt8)
   // has been setup
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 CartridgeF8SC::currentBank(uInt16) const
+{
+  return myCurrentBank;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void CartridgeF8SC::bank(uInt16 bank)
 { 
   // Remember what bank we're in
   myCurrentBank = bank;
-  uInt16 offset = myCurrentBank << 12;
-  uInt16 shift = mySystem->pageShift();
   uInt16 mask = mySystem->pageMask();
 
-  // Setup the page access methods for the current bank
-  System::PageAccess access;
-  access.device = this;
-  access.directPokeBase = 0;
-
   // Map ROM image into the system
-  for(uInt32 address = 0x1100; address < (0x1FF8U & ~mask);
-      address += (1 << shift))
-  {
-    access.directPeekBase = &myImage[offset + (address & 0x0FFF)];
-    mySystem->setPageAccess(address >> shift, access);
-  }
+  installBank(myBankMap, 0x1100, 0x1FF8U & ~mask, myCurrentBank);
 }
@@ -20,6 +20,8 @@
 #include "CartFASC.hxx"
 #include "Random.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -37,11 +39,15 @@ CartridgeFASC::CartridgeFASC(const uInt8* image)
   {
     myRAM[i] = random.next();
   }
+
+  // The page accesses of the banks are built by install
+  myBankMap = 0;
 }
  
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeFASC::~CartridgeFASC()
 {
+  delete[] myBankMap;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -74,6 +80,7 @@ void CartridgeFASC::install(System& system)
     access.directPeekBase = 0;
     access.directPokeBase = 0;
     access.device = this;
+    access.type = System::PageHotspot;
     mySystem->setPageAccess(i >> shift, access);
   }
 
@@ -83,6 +90,7 @@ void CartridgeFASC::install(System& system)
     access.device = this;
     access.directPeekBase = 0;
     access.directPokeBase = &myRAM[j & 0x00FF];
+    access.type = System::PageRAM;
     mySystem->setPageAccess(j >> shift, access);
   }
  
@@ -92,13 +100,42 @@ void CartridgeFASC::install(System& system)
     access.device = this;
     access.directPeekBase = &myRAM[k & 0x00FF];
     access.directPokeBase = 0;
+    access.type = System::PageRAM;
     mySystem->setPageAccess(k >> shift, access);
   }
 
+  // Build the page accesses of every bank, so a bank switch is a copy
+  myBankMap = createBankMap(0x1200, 0x1FF8U & ~mask, &myImage[0x0200], 0,
+      4096, 3, System::PageROM);
+
   // Install pages for bank 2
   bank(2);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeFASC::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putShort(myCurrentBank);
+  out.putBytes(myRAM, sizeof(myRAM));
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeFASC::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  uInt16 bank = in.getShort();
+  in.getBytes(myRAM, sizeof(myRAM));
+  this->bank(bank);
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 CartridgeFASC::peek(uInt16 address)
 {
@@ -164,25 +201,19 @@ void CartridgeFASC::poke(uInt16 address, uInt8)
   // has been setup
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 CartridgeFASC::currentBank(uInt16) const
+{
+  return myCurrentBank;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void CartridgeFASC::bank(uInt16 bank)
 {
   // Remember what bank we're in
   myCurrentBank = bank;
-  uInt16 offset = myCurrentBank * 4096;
-  uInt16 shift = mySystem->pageShift();
   uInt16 mask = mySystem->pageMask();
 
-  // Setup the page access methods for the current bank
-  System::PageAccess access;
-  access.device = this;
-  access.directPokeBase = 0;
-
   // Map ROM image into the system
-  for(uInt32 address = 0x1200; address < (0x1FF8U & ~mask);
-      address += (1 << shift))
-  {
-    access.directPeekBase = &myImage[offset + (address & 0x0FFF)];
-    mySystem->setPageAccess(address >> shift, access);
-  }
+  installBank(myBankMap, 0x1200, 0x1FF8U & ~mask, myCurrentBank);
 }
@@ -20,6 +20,8 @@
 #include "CartMC.hxx"
 #include "Random.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -99,23 +101,52 @@ void CartridgeMC::install(System& system)
     access.directPeekBase = 0;
     access.directPokeBase = 0;
     access.device = this;
+    access.type = System::PageHotspot;
     mySystem->setPageAccess(i >> shift, access);
   }
 
   // Map the cartridge into the system
-  for(uInt32 j = 0x1000; j < 0x2000; j += (1 << shift))
+  for(uInt16 slot = 0; slot < 4; ++slot)
   {
-    access.device = this;
-    access.directPeekBase = 0;
-    access.directPokeBase = 0;
-    mySystem->setPageAccess(j >> shift, access);
+    mapSlot(slot);
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeMC::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putBytes(myCurrentBlock, sizeof(myCurrentBlock));
+  out.putBool(mySlot3Locked);
+  out.putBytes(myRAM, 32 * 1024);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool CartridgeMC::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  in.getBytes(myCurrentBlock, sizeof(myCurrentBlock));
+  mySlot3Locked = in.getBool();
+  in.getBytes(myRAM, 32 * 1024);
+
+  for(uInt16 slot = 0; slot < 4; ++slot)
+  {
+    mapSlot(slot);
   }
+
+  return in.isValid();
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 CartridgeMC::peek(uInt16 address)
 {
   address = address & 0x1FFF;
+  bool locked = mySlot3Locked;
 
   // Accessing the RESET vector so lets handle the powerup special case
   if((address == 0x1FFC) || (address == 0x1FFD))
@@ -130,6 +161,15 @@ uInt8 CartridgeMC::peek(uInt16 address)
     mySlot3Locked = false;
   }
 
+  // Locking and unlocking changes what all of the slots trap
+  if(mySlot3Locked != locked)
+  {
+    for(uInt16 slot = 0; slot < 4; ++slot)
+    {
+      mapSlot(slot);
+    }
+  }
+
   // Handle reads made to the TIA addresses
   if(address < 0x1000)
   {
@@ -176,6 +216,7 @@ uInt8 CartridgeMC::peek(uInt16 address)
 void CartridgeMC::poke(uInt16 address, uInt8 value)
 {
   address = address & 0x1FFF;
+  bool locked = mySlot3Locked;
 
   // Accessing the RESET vector so lets handle the powerup special case
   if((address == 0x1FFC) || (address == 0x1FFD))
@@ -190,10 +231,20 @@ void CartridgeMC::poke(uInt16 address, uInt8 value)
     mySlot3Locked = false;
   }
 
+  // Locking and unlocking changes what all of the slots trap
+  if(mySlot3Locked != locked)
+  {
+    for(uInt16 slot = 0; slot < 4; ++slot)
+    {
+      mapSlot(slot);
+    }
+  }
+
   // Handle bank-switching writes
   if((address >= 0x003C) && (address <= 0x003F))
   {
     myCurrentBlock[address - 0x003C] = value;
+    mapSlot(address - 0x003C);
   }
   else
   {
@@ -216,3 +267,52 @@ void CartridgeMC::poke(uInt16 address, uInt8 value)
     }
   }  
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void CartridgeMC::mapSlot(uInt16 slot)
+{
+  uInt16 shift = mySystem->pageShift();
+  uInt16 mask = mySystem->pageMask();
+  uInt8 block = (mySlot3Locked && (slot == 3)) ? 0xFF : myCurrentBlock[slot];
+
+  System::PageAccess access;
+  access.device = this;
+
+  for(uInt32 address = 0x1000 + (slot << 10);
+      address < 0x1400U + (slot << 10); address += (1 << shift))
+  {
+    access.directPeekBase = 0;
+    access.directPokeBase = 0;
+
+    // While slot 3 is locked any access to the other slots unlocks it,
+    // and reading the RESET vector locks it, so those go through peek
+    if((mySlot3Locked && (slot != 3)) || (address == (0x1FFCU & ~mask)))
+    {
+      access.type = System::PageDevice;
+    }
+    else if(block & 0x80)
+    {
+      // ROM block
+      access.directPeekBase =
+          &myImage[(uInt32)(block & 0x7F) * 1024 + (address & 0x03FF)];
+      access.type = System::PageROM;
+    }
+    else if(address & 0x0200)
+    {
+      // Read port of the RAM block
+      access.directPeekBase =
+          &myRAM[(uInt32)(block & 0x3F) * 512 + (address & 0x01FF)];
+      access.type = System::PageRAM;
+    }
+    else
+    {
+      // Write port of the RAM block (reading it clears the byte, so reads
+      // still go through peek)
+      access.directPokeBase =
+          &myRAM[(uInt32)(block & 0x3F) * 512 + (address & 0x01FF)];
+      access.type = System::PageRAM;
+    }
+
+    mySystem->setPageAccess(address >> shift, access);
+  }
+}
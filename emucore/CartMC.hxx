@@ -174,6 +174,22 @@ class CartridgeMC : public Cartridge
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
   public:
     /**
       Get the byte at the specified address
@@ -190,6 +206,16 @@ class CartridgeMC : public Cartridge
     */
     virtual void poke(uInt16 address, uInt8 value);
 
+  private:
+    /**
+      Install pages for the block selected in the specified slot.  ROM
+      blocks and the RAM's ports are mapped directly, leaving only the
+      accesses that change the cartridge's state to peek and poke.
+
+      @param slot The slot (0 to 3) to install pages for
+    */
+    void mapSlot(uInt16 slot);
+
   private:
     // Indicates which block is currently active for the four segments
     uInt8 myCurrentBlock[4];
@@ -30,11 +30,15 @@
 #include "Joystick.hxx"
 #include "Keyboard.hxx"
 #include "M6502Low.hxx"
+#include "M6502LowJump.hxx"
+#include "M6502LowJit.hxx"
 #include "M6502Hi.hxx"
 #include "M6532.hxx"
 #include "MD5.hxx"
 #include "MediaSrc.hxx"
 #include "Paddles.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include "Sound.hxx"
 #include "Switches.hxx"
 #include "System.hxx"
@@ -43,8 +47,10 @@
 extern uInt32 console_controleurtype;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Console::Console(const uInt8* image, uInt32 size, const char* filename, Sound& sound)
-    : mySound(sound)
+Console::Console(const uInt8* image, uInt32 size, const char* filename, Sound& sound,
+    CPUCore core)
+    : mySound(sound),
+      myFilename(filename)
 {
   myControllers[0] = 0;
   myControllers[1] = 0;
@@ -58,7 +64,7 @@ Console::Console(const uInt8* image, uInt32 size, const char* filename, Sound& s
   myEvent = myEventHandler->event();
 
   // Get the MD5 message-digest for the ROM image
-  string md5 = MD5(image, size);
+  myMD5 = MD5(image, size);
 
   if (console_controleurtype == 0)
     myControllers[0] = new Joystick(Controller::Left, *myEvent);
@@ -69,7 +75,13 @@ Console::Console(const uInt8* image, uInt32 size, const char* filename, Sound& s
   mySwitches = new Switches(*myEvent);
   mySystem = new System(13, 6);
 
-  M6502* m6502 = new M6502Low(1);
+  M6502* m6502;
+  if(core == CPUSwitch)
+    m6502 = new M6502Low(1);
+  else if(core == CPUJit)
+    m6502 = new M6502LowJit(1);
+  else
+    m6502 = new M6502LowJump(1);
   //M6502* m6502 = new M6502High(1);
 
   M6532* m6532 = new M6532(*this);
@@ -110,10 +122,65 @@ Console::~Console()
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Console::update()
+void Console::update(bool draw)
 {
 // myFrameBuffer.update();
-	myMediaSource->update();
+	myMediaSource->update(draw);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Console::saveState(Serializer& out)
+{
+  out.putString("Stella");
+  out.putString(myMD5);
+
+  return mySystem->save(out);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Console::loadState(Deserializer& in)
+{
+  // Make sure the state belongs to this game before touching anything
+  if((in.getString() != "Stella") || (in.getString() != myMD5))
+    return false;
+
+  return mySystem->load(in);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Console::saveState(const string& filename)
+{
+  Serializer out;
+  if(!saveState(out))
+    return false;
+
+  ofstream file(filename.c_str(), ios::out | ios::binary);
+  if(!file)
+    return false;
+
+  file.write((const char*)out.data(), out.size());
+  return file.good();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Console::loadState(const string& filename)
+{
+  ifstream file(filename.c_str(), ios::in | ios::binary);
+  if(!file)
+    return false;
+
+  file.seekg(0, ios::end);
+  uInt32 size = file.tellg();
+  file.seekg(0, ios::beg);
+
+  uInt8* buffer = new uInt8[size];
+  file.read((char*)buffer, size);
+
+  Deserializer in(buffer, size);
+  bool result = file.good() && loadState(in);
+
+  delete[] buffer;
+  return result;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
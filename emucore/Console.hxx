@@ -21,9 +21,11 @@
 
 class Console;
 class Controller;
+class Deserializer;
 class Event;
 class EventHandler;
 class MediaSource;
+class Serializer;
 class Sound;
 class Switches;
 class System;
@@ -41,6 +43,16 @@ class System;
 class Console
 {
   public:
+    /**
+      The 6502 emulation cores a console can be created with
+    */
+    enum CPUCore
+    {
+      CPUSwitch,      // M6502Low, switch based instruction dispatch
+      CPUThreaded,    // M6502LowJump, computed goto instruction dispatch
+      CPUJit          // M6502LowJit, ROM code translated to x86-64
+    };
+
     /**
       Create a new console for emulating the specified game using the
       given event object and game profiles.
@@ -52,8 +64,10 @@ class Console
       @param profiles    The game profiles object to use
       @param framebuffer The framebuffer object to use
       @param sound       The sound object to use
+      @param core        The 6502 emulation core to use
     */
-    Console(const uInt8* image, uInt32 size, const char* filename,  Sound& sound);
+    Console(const uInt8* image, uInt32 size, const char* filename,  Sound& sound,
+        CPUCore core = CPUThreaded);
 
     /**
       Create a new console object by copying another one
@@ -71,8 +85,55 @@ class Console
     /**
       Updates the console by one frame.  Each frontend should
       call this method 'framerate' times per second.
+
+      @param draw False to skip drawing the frame when the frontend is
+                  falling behind
+    */
+    void update(bool draw = true);
+
+    /**
+      Save the complete state of the emulated machine.  The state is
+      tagged with the MD5 of the ROM image so it can only be loaded back
+      into a console running the same game.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    bool saveState(Serializer& out);
+
+    /**
+      Restore the complete state of the emulated machine.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    bool loadState(Deserializer& in);
+
+    /**
+      Save the complete state of the emulated machine to a file.
+
+      @param filename The file to save the state to
+      @return False on any errors, else true
+    */
+    bool saveState(const string& filename);
+
+    /**
+      Restore the complete state of the emulated machine from a file.
+
+      @param filename The file to load the state from
+      @return False on any errors, else true
     */
-    void update();
+    bool loadState(const string& filename);
+
+    /**
+      Get the name of the ROM file the console was created with
+
+      @return The filename given to the constructor
+    */
+    const string& filename() const
+    {
+      return myFilename;
+    }
 
     /**
       Get the controller plugged into the specified jack
@@ -182,5 +243,9 @@ class Console
 
     // Pointer to the EventHandler object
     EventHandler* myEventHandler;
+
+    // The ROM filename and its MD5 message-digest
+    string myFilename;
+    string myMD5;
 };
 #endif
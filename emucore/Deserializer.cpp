@@ -0,0 +1,113 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll       
+//  SS  SS   tt           ll   ll        
+//  SS     tttttt  eeee   ll   ll   aaaa 
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2005 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#include <string.h>
+#include "Deserializer.hxx"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Deserializer::Deserializer(const uInt8* data, uInt32 size)
+    : myData(data),
+      mySize(size),
+      myPosition(0),
+      myValid(true)
+{
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Deserializer::~Deserializer()
+{
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt8 Deserializer::getByte()
+{
+  if(myPosition >= mySize)
+  {
+    myValid = false;
+    return 0;
+  }
+
+  return myData[myPosition++];
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 Deserializer::getShort()
+{
+  uInt16 value = getByte();
+  value |= (uInt16)getByte() << 8;
+
+  return value;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 Deserializer::getInt()
+{
+  uInt32 value = getByte();
+  value |= (uInt32)getByte() << 8;
+  value |= (uInt32)getByte() << 16;
+  value |= (uInt32)getByte() << 24;
+
+  return value;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Deserializer::getBool()
+{
+  return getByte() != 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+double Deserializer::getDouble()
+{
+  double value;
+  getBytes((uInt8*)&value, sizeof(double));
+
+  return value;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+string Deserializer::getString()
+{
+  uInt32 length = getShort();
+
+  if(length > mySize - myPosition)
+  {
+    myValid = false;
+    return "";
+  }
+
+  string str((const char*)myData + myPosition, length);
+  myPosition += length;
+
+  return str;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Deserializer::getBytes(uInt8* buf, uInt32 length)
+{
+  if(length > mySize - myPosition)
+  {
+    memset(buf, 0, length);
+    myPosition = mySize;
+    myValid = false;
+    return;
+  }
+
+  memcpy(buf, myData + myPosition, length);
+  myPosition += length;
+}
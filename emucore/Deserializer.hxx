@@ -0,0 +1,130 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll       
+//  SS  SS   tt           ll   ll        
+//  SS     tttttt  eeee   ll   ll   aaaa 
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2005 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#ifndef DESERIALIZER_HXX
+#define DESERIALIZER_HXX
+
+#include "bspf.hxx"
+
+/**
+  This class reads back the state written by a Serializer.  It only
+  references the given data, which must stay valid while it's in use.
+
+  Reading past the end of the data doesn't crash: the missing bytes read
+  as zero and the deserializer is flagged invalid, so a loader can check
+  isValid() once at the end instead of after every value.
+
+  @version $Id$
+*/
+class Deserializer
+{
+  public:
+    /**
+      Create a new deserializer for the given data
+
+      @param data The serialized data
+      @param size The size of the data in bytes
+    */
+    Deserializer(const uInt8* data, uInt32 size);
+
+    /**
+      Destructor
+    */
+    virtual ~Deserializer();
+
+  public:
+    /**
+      Answers true iff nothing has been read past the end of the data
+
+      @return The validity of everything read so far
+    */
+    bool isValid() const { return myValid; }
+
+    /**
+      Answers true iff all of the data has been read
+
+      @return True if there's nothing left to read
+    */
+    bool atEnd() const { return myPosition >= mySize; }
+
+  public:
+    /**
+      Reads a byte value from the buffer
+
+      @return The byte value which has been read
+    */
+    uInt8 getByte();
+
+    /**
+      Reads a 16-bit value from the buffer
+
+      @return The short value which has been read
+    */
+    uInt16 getShort();
+
+    /**
+      Reads a 32-bit value from the buffer
+
+      @return The integer value which has been read
+    */
+    uInt32 getInt();
+
+    /**
+      Reads a boolean value from the buffer
+
+      @return The boolean value which has been read
+    */
+    bool getBool();
+
+    /**
+      Reads a double value from the buffer
+
+      @return The double value which has been read
+    */
+    double getDouble();
+
+    /**
+      Reads a string from the buffer
+
+      @return The string which has been read
+    */
+    string getString();
+
+    /**
+      Reads a block of bytes from the buffer
+
+      @param buf The place to store the bytes
+      @param length The number of bytes to read
+    */
+    void getBytes(uInt8* buf, uInt32 length);
+
+  private:
+    // The serialized data
+    const uInt8* myData;
+
+    // The size of the data in bytes
+    uInt32 mySize;
+
+    // The position of the next byte to read
+    uInt32 myPosition;
+
+    // Indicates that nothing has been read past the end of the data
+    bool myValid;
+};
+
+#endif
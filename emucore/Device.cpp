@@ -35,3 +35,10 @@ void Device::systemCyclesReset()
   // By default I do nothing when my system resets its cycle counter
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Device::peekIdle(uInt16, uInt32, uInt8&, uInt32&)
+{
+  // By default reads can't be predicted
+  return false;
+}
+
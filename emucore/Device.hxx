@@ -20,6 +20,8 @@
 #define DEVICE_HXX
 
 class System;
+class Serializer;
+class Deserializer;
 
 #include "bspf.hxx"
 
@@ -71,6 +73,22 @@ class Device
     */
     virtual void install(System& system) = 0;
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out) = 0;
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in) = 0;
+
   public:
     /**
       Get the byte at the specified address
@@ -87,6 +105,23 @@ class Device
     */
     virtual void poke(uInt16 address, uInt8 value) = 0;
 
+    /**
+      Answers whether the specified address can be polled without side
+      effects while nothing but the passage of time changes what reading
+      it returns.  If so, gives what peek() would return with the system
+      cycle counter at the given cycle, and the first cycle after that at
+      which it may return something else.  Used by the processor to skip
+      over loops polling the address.  By default devices answer false.
+
+      @param address The address being polled
+      @param cycle The system cycle of the read
+      @param value Set to the byte read
+      @param nextChange Set to the cycle at which the byte may change
+      @return true iff reading the address can be predicted
+    */
+    virtual bool peekIdle(uInt16 address, uInt32 cycle, uInt8& value,
+        uInt32& nextChange);
+
   protected:
     /// Pointer to the system the device is installed in or the null pointer
     System* mySystem;
@@ -107,9 +107,8 @@ void EventHandler::sendEvent(Event::Type event, Int32 state)
   // Ignore unmapped events
   if(event == Event::NoType)
     return;
-#if 0
-  // Take care of special events that aren't technically part of
-  // the emulation core
+
+  // Take care of the state events, they aren't part of the emulation core
   if(state == 1)
   {
     if(event == Event::SaveState)
@@ -127,7 +126,13 @@ void EventHandler::sendEvent(Event::Type event, Int32 state)
       loadState();
       return;
     }
-    else if(event == Event::TakeSnapshot)
+  }
+#if 0
+  // Take care of special events that aren't technically part of
+  // the emulation core
+  if(state == 1)
+  {
+    if(event == Event::TakeSnapshot)
     {
       takeSnapshot();
       return;
@@ -318,19 +323,34 @@ bool EventHandler::isValidList(string list, uInt32 length)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void EventHandler::saveState()
 {
-;
+  myConsole->saveState(stateFilename());
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void EventHandler::changeState()
 {
-;
+  myCurrentState = (myCurrentState + 1) % 10;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void EventHandler::loadState()
 {
-;
+  myConsole->loadState(stateFilename());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+string EventHandler::stateFilename() const
+{
+  // The state files live next to the ROM as <rom>.st0 ... <rom>.st9
+  string filename = myConsole->filename();
+  string::size_type pos = filename.find_last_of('.');
+  if((pos != string::npos) && (filename.find_first_of("/\\", pos) == string::npos))
+    filename.erase(pos);
+
+  filename += ".st";
+  filename += (char)('0' + myCurrentState);
+
+  return filename;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -122,6 +122,9 @@ class EventHandler
     void loadState();
     void takeSnapshot();
 
+    // The state file for the current state slot
+    string stateFilename() const;
+
   private:
     // Array of key events
     Event::Type myKeyTable[StellaEvent::LastKCODE];
@@ -17,6 +17,8 @@
 //============================================================================
 
 #include "M6502.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 M6502::M6502(uInt32 systemCyclesPerProcessorCycle)
@@ -24,6 +26,10 @@ M6502::M6502(uInt32 systemCyclesPerProcessorCycle)
       mySystem(0),
       mySystemCyclesPerProcessorCycle(systemCyclesPerProcessorCycle)
 {
+#ifdef M6502_TRACE
+  myTracer = 0;
+#endif
+
   uInt16 t;
 
   // Compute the BCD lookup table
@@ -53,6 +59,41 @@ void M6502::install(System& system)
   mySystem = &system;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool M6502::save(Serializer& out)
+{
+  out.putString("M6502");
+
+  out.putByte(A);
+  out.putByte(X);
+  out.putByte(Y);
+  out.putByte(SP);
+  out.putByte(IR);
+  out.putShort(PC);
+  out.putByte(PS());
+  out.putByte(myExecutionStatus);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool M6502::load(Deserializer& in)
+{
+  if(in.getString() != "M6502")
+    return false;
+
+  A = in.getByte();
+  X = in.getByte();
+  Y = in.getByte();
+  SP = in.getByte();
+  IR = in.getByte();
+  PC = in.getShort();
+  PS(in.getByte());
+  myExecutionStatus = in.getByte();
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void M6502::reset()
 {
@@ -97,7 +138,7 @@ uInt8 M6502::PS() const
 {
   uInt8 ps = 0x20;
 
-  if(N) 
+  if(NZ & 0x180) 
     ps |= 0x80;
   if(V) 
     ps |= 0x40;
@@ -107,7 +148,7 @@ uInt8 M6502::PS() const
     ps |= 0x08;
   if(I) 
     ps |= 0x04;
-  if(!notZ) 
+  if(!(NZ & 0xff)) 
     ps |= 0x02;
   if(C) 
     ps |= 0x01;
@@ -118,13 +159,14 @@ uInt8 M6502::PS() const
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void M6502::PS(uInt8 ps)
 {
-  N = ps & 0x80;
   V = ps & 0x40;
   B = ps & 0x10;
   D = ps & 0x08;
   I = ps & 0x04;
-  notZ = !(ps & 0x02);
   C = ps & 0x01;
+
+  // Low byte zero for Z, and bit 8 for N so it doesn't clear Z
+  NZ = ((ps & 0x02) ? 0x00 : 0x01) | ((ps & 0x80) << 1);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
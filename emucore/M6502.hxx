@@ -21,10 +21,55 @@
 
 class D6502;
 class M6502;
+class Serializer;
+class Deserializer;
 
 #include "bspf.hxx"
 #include "System.hxx"
 
+#ifdef M6502_TRACE
+/**
+  Receives every instruction executed by a 6502 core and every memory
+  access made by the instructions themselves (opcode and operand fetches
+  are left out since the cores predecode them).  Used by the lockstep
+  harness to compare cores, and only compiled in when M6502_TRACE is
+  defined so the other builds pay nothing for it.
+
+  @version $Id$
+*/
+class M6502Tracer
+{
+  public:
+    virtual ~M6502Tracer() { }
+
+    /**
+      Called after each instruction with the registers it left.
+
+      @param ir The opcode of the instruction
+      @param pc The address of the next instruction
+      @param a The accumulator
+      @param x The X index register
+      @param y The Y index register
+      @param sp The stack pointer
+      @param ps The processor status register
+      @param cycles The system cycle counter
+    */
+    virtual void instruction(uInt8 ir, uInt16 pc, uInt8 a, uInt8 x, uInt8 y,
+        uInt8 sp, uInt8 ps, uInt32 cycles) = 0;
+
+    /**
+      Called for each read or write by an instruction.
+
+      @param address The address accessed
+      @param value The byte read or written
+      @param write True for a write
+      @param cycles The system cycle counter
+    */
+    virtual void access(uInt16 address, uInt8 value, bool write,
+        uInt32 cycles) = 0;
+};
+#endif
+
 /**
   This is an abstract base class for classes that emulate the
   6502 microprocessor.  The 6502 is an 8-bit microprocessor that
@@ -41,6 +86,11 @@ class M6502
     */
     friend class D6502;
 
+    /**
+      The profiler disassembles with the mnemonic table
+    */
+    friend class M6502Profiler;
+
   public:
     /**
       Enumeration of the 6502 addressing modes
@@ -76,6 +126,24 @@ class M6502
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this processor to the given Serializer.
+      The state doesn't depend on the derived class, so it can be loaded
+      into any of the 6502 cores.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this processor from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
   public:
     /**
       Reset the processor to its power-on state.  This method should not 
@@ -121,6 +189,17 @@ class M6502
     */
     virtual bool execute(uInt32 number) = 0;
 
+    /**
+      Execute instructions until the system cycle counter reaches the
+      specified cycle, someone stops execution, or an error occurs.  The
+      deadline is checked before each instruction, so the last one may
+      run a few cycles past it.  Answers true iff execution stops normally.
+
+      @param targetCycle The system cycle to stop at
+      @return true iff execution stops normally
+    */
+    virtual bool executeCycles(uInt32 targetCycle) = 0;
+
     /**
       Tell the processor to stop executing instructions.  Invoking this 
       method while the processor is executing instructions will stop 
@@ -138,6 +217,18 @@ class M6502
     {
       return myExecutionStatus & FatalErrorBit;
     }
+
+#ifdef M6502_TRACE
+    /**
+      Send the instructions and their accesses to the specified tracer.
+
+      @param tracer The tracer, or the null pointer to stop tracing
+    */
+    void setTracer(M6502Tracer* tracer)
+    {
+      myTracer = tracer;
+    }
+#endif
   
   public:
     /**
@@ -171,14 +262,20 @@ class M6502
 	uInt8 IR;   // Instruction register
 	uInt16 PC;  // Program Counter
 
-    bool N;     // N flag for processor status register
     bool V;     // V flag for processor status register
     bool B;     // B flag for processor status register
     bool D;     // D flag for processor status register
     bool I;     // I flag for processor status register
-    bool notZ;  // Z flag complement for processor status register
     bool C;     // C flag for processor status register
 
+    /**
+      The N and Z flags are not computed by the instructions setting them,
+      they keep the result instead: Z is set when its low byte is zero and
+      N when bit 7 or 8 is set.  Bit 8 lets BIT and PLP set N when bit 7
+      of the low byte is clear.
+    */
+    uInt16 NZ;
+
     /** 
       Bit fields used to indicate that certain conditions need to be 
       handled such as stopping execution, fatal errors, maskable interrupts 
@@ -206,6 +303,11 @@ class M6502
     /// Table of system cycles for each instruction
     uInt32 myInstructionSystemCycleTable[256]; 
 
+#ifdef M6502_TRACE
+    /// Tracer told about each instruction, or the null pointer
+    M6502Tracer* myTracer;
+#endif
+
   protected:
     /// Addressing mode for each of the 256 opcodes
     static AddressingMode ourAddressingModeTable[256];
@@ -16,51 +16,88 @@
 // $Id: M6502Low.cxx,v 1.2 2002/05/13 19:10:25 stephena Exp $
 //============================================================================
 
+#include "Device.hxx"
 #include "M6502Low.hxx"
 
 #define debugStream cout
 
+// Operands come from fetch() rather than from memory
+#define FETCH_BYTE() ((uInt8)operandFetched)
+#define FETCH_WORD(_dest) _dest = operandFetched
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 M6502Low::M6502Low(uInt32 systemCyclesPerProcessorCycle)
-    : M6502(systemCyclesPerProcessorCycle)
+    : M6502(systemCyclesPerProcessorCycle),
+      myDecodeCache(0),
+      myDecodeGeneration(0),
+      myIdleLoopDeadline(0)
 {
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 M6502Low::~M6502Low()
 {
+  delete[] myDecodeCache;
+  delete[] myDecodeGeneration;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-inline uInt8 M6502Low::peek(uInt16 address)
+void M6502Low::install(System& system)
 {
-  return mySystem->peek(address);
+  M6502::install(system);
+
+  myAddressMask = system.addressMask();
+  myPageShift = system.pageShift();
+  myPageMask = system.pageMask();
+
+  // Nothing is decoded until a page's generation has been recorded, and
+  // generation 0 is never given to a mapped page
+  delete[] myDecodeCache;
+  delete[] myDecodeGeneration;
+  myDecodeCache = new DecodedInstruction[myAddressMask + 1];
+  myDecodeGeneration = new uInt32[system.numberOfPages()];
+  for(uInt32 page = 0; page < system.numberOfPages(); ++page)
+  {
+    myDecodeGeneration[page] = 0;
+  }
+  for(uInt32 address = 0; address <= myAddressMask; ++address)
+  {
+    myDecodeCache[address].length = 0;
+  }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-inline void M6502Low::poke(uInt16 address, uInt8 value)
+bool M6502Low::execute(uInt32 number)
 {
-  mySystem->poke(address, value);
+  return executeUntil(number, 0xFFFFFFFF);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-bool M6502Low::execute(uInt32 number)
+bool M6502Low::executeCycles(uInt32 targetCycle)
+{
+  return executeUntil(0xFFFFFFFF, targetCycle);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool M6502Low::executeUntil(uInt32 number, uInt32 targetCycle)
 {
   // Clear all of the execution status bits except for the fatal error bit
   myExecutionStatus &= FatalErrorBit;
 
+  // Skipped loop iterations aren't counted as executed instructions
+  myIdleLoopDeadline = (number == 0xFFFFFFFF) ? targetCycle : 0;
+
   // Loop until execution is stopped or a fatal error occurs
   for(;;)
   {
-    for(; !myExecutionStatus && (number != 0); --number)
+    for(; !myExecutionStatus && (number != 0) &&
+        (mySystem->cycles() < targetCycle); --number)
     {
       uInt16 operandAddress = 0;
       uInt8 operand = 0;
-		
-      IR = peek(PC++);
 
-      // Update system cycles
-      mySystem->incrementCycles(myInstructionSystemCycleTable[IR]); 
+      // Get the instruction and update system cycles
+      uInt16 operandFetched = fetch();
 
       // Call code to execute the instruction
       switch(IR)
@@ -73,6 +110,8 @@ bool M6502Low::execute(uInt32 number)
           myExecutionStatus |= FatalErrorBit;
           cerr << "Illegal Instruction! " << hex << (int) IR << endl;
       }
+
+      M6502_TRACE_INSTRUCTION();
     }
 
     // See if we need to handle an interrupt
@@ -97,8 +136,9 @@ bool M6502Low::execute(uInt32 number)
       return false;
     }
 
-    // See if we've executed the specified number of instructions
-    if(number == 0)
+    // See if we've executed the specified number of instructions or
+    // reached the target cycle
+    if((number == 0) || (mySystem->cycles() >= targetCycle))
     {
       // Yes, so answer that everything finished fine
       return true;
@@ -106,6 +146,164 @@ bool M6502Low::execute(uInt32 number)
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt16 M6502Low::decode()
+{
+  uInt16 address = PC & myAddressMask;
+  const System::PageAccess& access = mySystem->getPageAccess(address >> myPageShift);
+  uInt32 generation = access.generation;
+
+  IR = mySystem->peek(PC++);
+
+  // Update system cycles before the operand is read, as the other cores do
+  mySystem->incrementCycles(myInstructionSystemCycleTable[IR]);
+
+  uInt16 operand = 0;
+  uInt8 bytes = ourOperandBytesTable[IR];
+  if(bytes > 0)
+  {
+    operand = mySystem->peek(PC++);
+  }
+  if(bytes > 1)
+  {
+    operand |= (uInt16)mySystem->peek(PC++) << 8;
+  }
+
+  // Keep instructions which come from ROM, as long as the page wasn't
+  // remapped by the fetch and the operand doesn't run onto the next page
+  if((access.type == System::PageROM) && (access.generation == generation) &&
+     ((address & myPageMask) + bytes <= myPageMask))
+  {
+    DecodedInstruction& code = myDecodeCache[address];
+    code.opcode = IR;
+    code.length = bytes + 1;
+    code.cycles = myInstructionSystemCycleTable[IR];
+    code.last = mySystem->getDataBusState();
+    code.operand = operand;
+  }
+
+  return operand;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502Low::flushPage(uInt16 page, uInt32 generation)
+{
+  DecodedInstruction* code = myDecodeCache + (page << myPageShift);
+  for(uInt32 i = 0; i <= myPageMask; ++i)
+  {
+    code[i].length = 0;
+  }
+  myDecodeGeneration[page] = generation;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502Low::skipIdleLoop()
+{
+  // Something is waiting for execution to stop
+  if(myExecutionStatus)
+  {
+    return;
+  }
+
+  // The loop's code has to be readable without side effects
+  uInt16 address = PC & myAddressMask;
+  const System::PageAccess& code =
+      mySystem->getPageAccess(address >> myPageShift);
+  if((code.directPeekBase == 0) || ((address & myPageMask) + 4 > myPageMask))
+  {
+    return;
+  }
+  const uInt8* loop = code.directPeekBase + (address & myPageMask);
+
+  uInt8 load = loop[0];
+  if(((load != 0xad) && (load != 0xae) && (load != 0xac) && (load != 0x2c)) ||
+      (loop[3] != IR) || (loop[4] != 0xfb))
+  {
+    return;
+  }
+
+  // And it has to poll a device
+  uInt16 target = (uInt16)loop[1] | ((uInt16)loop[2] << 8);
+  const System::PageAccess& io =
+      mySystem->getPageAccess((target & myAddressMask) >> myPageShift);
+  if((io.directPeekBase != 0) || (io.device == 0))
+  {
+    return;
+  }
+
+  // Cycles from the start of an iteration to the read, and per iteration
+  uInt32 readCycles = myInstructionSystemCycleTable[load];
+  uInt32 loopCycles = readCycles + myInstructionSystemCycleTable[IR] +
+      ((((PC + 5) ^ PC) & 0xff00) ?
+      mySystemCyclesPerProcessorCycle << 1 : mySystemCyclesPerProcessorCycle);
+
+  uInt32 start = mySystem->cycles();
+  uInt32 cycles = start;
+  uInt8 value = 0;
+  for(;;)
+  {
+    // An iteration only runs if neither the read nor the branch after it
+    // is past the deadline
+    uInt32 read = cycles + readCycles;
+    if(read >= myIdleLoopDeadline)
+    {
+      break;
+    }
+
+    uInt8 polled;
+    uInt32 nextChange;
+    if(!io.device->peekIdle(target, read, polled, nextChange) ||
+        (nextChange <= read))
+    {
+      break;
+    }
+
+    // Flags the load leaves for the branch
+    bool n = polled & 0x80;
+    bool v = (load == 0x2c) ? (polled & 0x40) : V;
+    bool z = (load == 0x2c) ? !(A & polled) : !polled;
+
+    bool taken;
+    switch(IR)
+    {
+      case 0x10: taken = !n; break;
+      case 0x30: taken = n; break;
+      case 0x50: taken = !v; break;
+      case 0x70: taken = v; break;
+      case 0x90: taken = !C; break;
+      case 0xb0: taken = C; break;
+      case 0xd0: taken = !z; break;
+      default:   taken = z; break;
+    }
+    if(!taken)
+    {
+      break;
+    }
+
+    // Every iteration reading before the value changes goes the same way
+    uInt32 last = BSPF_min(nextChange, myIdleLoopDeadline) - 1;
+    uInt32 iterations = (last - read) / loopCycles + 1;
+    cycles += iterations * loopCycles;
+    value = polled;
+  }
+
+  if(cycles == start)
+  {
+    return;
+  }
+  mySystem->incrementCycles(cycles - start);
+
+  // Registers and flags as the last skipped load left them
+  switch(load)
+  {
+    case 0xad: A = value; break;
+    case 0xae: X = value; break;
+    case 0xac: Y = value; break;
+    default:   V = value & 0x40; break;
+  }
+  NZ = (load == 0x2c) ? ((A & value) | ((value & 0x80) << 1)) : value;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void M6502Low::interruptHandler()
 {
@@ -139,3 +337,24 @@ const char* M6502Low::name() const
 {
   return "M6502Low";
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+const uInt8 M6502Low::ourOperandBytesTable[256] = {
+//  0  1  2  3  4  5  6  7  8  9  a  b  c  d  e  f
+    0, 1, 0, 1, 1, 1, 1, 1, 0, 1, 0, 1, 2, 2, 2, 2,  // 0
+    1, 1, 0, 1, 1, 1, 1, 1, 0, 2, 0, 2, 2, 2, 2, 2,  // 1
+    0, 1, 0, 1, 1, 1, 1, 1, 0, 1, 0, 0, 2, 2, 2, 2,  // 2
+    1, 1, 0, 1, 0, 1, 1, 1, 0, 2, 0, 2, 0, 2, 2, 2,  // 3
+    0, 1, 0, 1, 0, 1, 1, 1, 0, 1, 0, 1, 2, 2, 2, 2,  // 4
+    1, 1, 0, 1, 0, 1, 1, 1, 0, 2, 0, 2, 0, 2, 2, 2,  // 5
+    0, 1, 0, 1, 0, 1, 1, 1, 0, 1, 0, 1, 2, 2, 2, 2,  // 6
+    1, 1, 0, 1, 0, 1, 1, 1, 0, 2, 0, 2, 0, 2, 2, 2,  // 7
+    1, 1, 0, 1, 1, 1, 1, 1, 0, 0, 0, 1, 2, 2, 2, 2,  // 8
+    1, 1, 0, 1, 1, 1, 1, 1, 0, 2, 0, 2, 2, 2, 2, 2,  // 9
+    1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 0, 1, 2, 2, 2, 2,  // a
+    1, 1, 0, 1, 1, 1, 1, 1, 0, 2, 0, 2, 2, 2, 2, 2,  // b
+    1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 0, 1, 2, 2, 2, 2,  // c
+    1, 1, 0, 1, 0, 1, 1, 1, 0, 2, 0, 2, 0, 2, 2, 2,  // d
+    1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 0, 0, 2, 2, 2, 2,  // e
+    1, 1, 0, 1, 0, 1, 1, 1, 0, 2, 0, 2, 0, 2, 2, 2,  // f
+};
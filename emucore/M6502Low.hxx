@@ -37,6 +37,11 @@ class M6507Low;
 
   If speed is the most important issue then use this class, however, if 
   better compatibility is neccessary use one of the other 6502 classes.
+
+  Instructions fetched from ROM pages are kept predecoded (opcode, operand
+  and cycle count) so running them again skips the fetches through the
+  system.  A page's decoded instructions are dropped as soon as its
+  generation number shows it has been remapped, i.e. on a bank switch.
   
   @author  Bradford W. Mott
   @version $Id: M6502Low.hxx,v 1.2 2002/05/13 19:10:25 stephena Exp $
@@ -58,6 +63,14 @@ class M6502Low : public M6502
     virtual ~M6502Low();
 
   public:
+    /**
+      Install the processor in the specified system.  Invoked by the
+      system when the processor is attached to it.
+
+      @param system The system the processor should install itself in
+    */
+    virtual void install(System& system);
+
     /**
       Execute instructions until the specified number of instructions
       is executed, someone stops execution, or an error occurs.  Answers
@@ -68,6 +81,16 @@ class M6502Low : public M6502
     */
     virtual bool execute(uInt32 number);
 
+    /**
+      Execute instructions until the system cycle counter reaches the
+      specified cycle, someone stops execution, or an error occurs.
+      Answers true iff execution stops normally.
+
+      @param targetCycle The system cycle to stop at
+      @return true iff execution stops normally
+    */
+    virtual bool executeCycles(uInt32 targetCycle);
+
     /**
       Get a null terminated string which is the processors's name (i.e. "M6532")
 
@@ -76,11 +99,58 @@ class M6502Low : public M6502
     virtual const char* name() const;
 
   protected:
+    /**
+      The execution loop behind execute() and executeCycles(): runs until
+      the number of instructions is executed, the system cycle counter
+      reaches the target cycle, someone stops execution, or an error
+      occurs.
+
+      @param number Indicates the number of instructions to execute
+      @param targetCycle The system cycle to stop at
+      @return true iff execution stops normally
+    */
+    virtual bool executeUntil(uInt32 number, uInt32 targetCycle);
+
     /**
       Called after an interrupt has be requested using irq() or nmi()
     */
     void interruptHandler();
 
+  protected:
+    /**
+      Fetch the instruction at PC into IR and charge its cycles, from the
+      decoded instructions when possible.  PC is left after the operand.
+
+      @return The instruction's operand (for FETCH_BYTE and FETCH_WORD)
+    */
+    inline uInt16 fetch();
+
+    /**
+      Fetch and decode the instruction at PC through the system, keeping
+      it if it can be reused.
+
+      @return The instruction's operand
+    */
+    uInt16 decode();
+
+    /**
+      Forget the decoded instructions of the specified page.
+
+      @param page The page that has been remapped
+      @param generation The generation number of the page's new mapping
+    */
+    void flushPage(uInt16 page, uInt32 generation);
+
+    /**
+      Called when a branch has been taken back to a 3 byte instruction.
+      If the loop is a load or BIT of a device register the device can
+      predict (i.e. the M6532 timer) followed by that branch, the
+      iterations which would be taken before the register changes the
+      branch, or the deadline is reached, are skipped by advancing the
+      system cycles and leaving the registers as the last one would.
+    */
+    void skipIdleLoop();
+
   protected:
     /*
       Get the byte at the specified address 
@@ -96,6 +166,101 @@ class M6502Low : public M6502
       @param value The value to be stored at the address
     */
     inline void poke(uInt16 address, uInt8 value);
+
+  protected:
+    // An instruction as it was fetched from ROM
+    struct DecodedInstruction
+    {
+      uInt8 opcode;
+      uInt8 length;     // Number of bytes fetched, 0 if not decoded
+      uInt8 cycles;     // System cycles charged for the instruction
+      uInt8 last;       // Last byte fetched, left on the data bus
+      uInt16 operand;
+    };
+
+    // Decoded instruction for each address, indexed by the masked address
+    DecodedInstruction* myDecodeCache;
+
+    // Generation number of the mapping the decoded instructions of each
+    // page came from
+    uInt32* myDecodeGeneration;
+
+    // Copies of the system's address and page masks
+    uInt16 myAddressMask;
+    uInt16 myPageShift;
+    uInt16 myPageMask;
+
+    // System cycle idle loops can be skipped up to, 0 when instructions
+    // are being counted
+    uInt32 myIdleLoopDeadline;
+
+    // Number of operand bytes fetched with FETCH_BYTE or FETCH_WORD by
+    // each instruction
+    static const uInt8 ourOperandBytesTable[256];
 };
+
+// Every core reports each instruction it has executed with this
+#ifdef M6502_TRACE
+  #define M6502_TRACE_INSTRUCTION() \
+      if(myTracer) \
+        myTracer->instruction(IR, PC, A, X, Y, SP, PS(), mySystem->cycles())
+#else
+  #define M6502_TRACE_INSTRUCTION()
+#endif
+
+// The accessors are shared with the cores derived from this one, so they
+// are defined here where every core's execute loop can inline them
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inline uInt8 M6502Low::peek(uInt16 address)
+{
+#ifdef M6502_TRACE
+  uInt8 value = mySystem->peek(address);
+  if(myTracer)
+  {
+    myTracer->access(address, value, false, mySystem->cycles());
+  }
+  return value;
+#else
+  return mySystem->peek(address);
+#endif
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inline void M6502Low::poke(uInt16 address, uInt8 value)
+{
+#ifdef M6502_TRACE
+  if(myTracer)
+  {
+    myTracer->access(address, value, true, mySystem->cycles());
+  }
+#endif
+  mySystem->poke(address, value);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inline uInt16 M6502Low::fetch()
+{
+  uInt16 address = PC & myAddressMask;
+  uInt16 page = address >> myPageShift;
+
+  uInt32 generation = mySystem->getPageAccess(page).generation;
+  if(myDecodeGeneration[page] != generation)
+  {
+    flushPage(page, generation);
+  }
+
+  const DecodedInstruction& code = myDecodeCache[address];
+  if(code.length == 0)
+  {
+    return decode();
+  }
+
+  IR = code.opcode;
+  PC += code.length;
+  mySystem->incrementCycles(code.cycles);
+  mySystem->setDataBusState(code.last);
+
+  return code.operand;
+}
 #endif
 
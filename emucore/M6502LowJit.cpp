@@ -0,0 +1,418 @@
+//============================================================================
+//
+// MM     MM  6666  555555  0000   2222
+// MMMM MMMM 66  66 55     00  00 22  22
+// MM MMM MM 66     55     00  00     22
+// MM  M  MM 66666  55555  00  00  22222  --  "A 6502 Microprocessor Emulator"
+// MM     MM 66  66     55 00  00 22
+// MM     MM 66  66 55  55 00  00 22
+// MM     MM  6666   5555   0000  222222
+//
+// Copyright (c) 1995-1998 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#include <string.h>
+#include "M6502LowJit.hxx"
+
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__unix__)
+  #include <sys/mman.h>
+  #define JIT_X86_64
+#endif
+
+#define debugStream cout
+
+// Operands come from the translated code or from fetch()
+#define FETCH_BYTE() ((uInt8)operandFetched)
+#define FETCH_WORD(_dest) _dest = operandFetched
+
+// Bytes of executable memory holding the translated code
+static const uInt32 ourCodeSize = 4 * 1024 * 1024;
+
+// Largest number of instructions translated into a block, and the most
+// code a block can take
+static const uInt32 ourMaxBlockInstructions = 32;
+static const uInt32 ourMaxBlockCode = 4 + ourMaxBlockInstructions * 56 + 2;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+M6502LowJit::M6502LowJit(uInt32 systemCyclesPerProcessorCycle)
+    : M6502LowJump(systemCyclesPerProcessorCycle),
+      myCode(0),
+      myCodeUsed(0),
+      myBlocks(0),
+      myBlockGeneration(0),
+      myTargetCycle(0)
+{
+#ifdef JIT_X86_64
+  void* code = mmap(0, ourCodeSize, PROT_READ | PROT_WRITE | PROT_EXEC,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  // Without executable memory everything is interpreted
+  if(code != MAP_FAILED)
+  {
+    myCode = (uInt8*)code;
+  }
+#endif
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+M6502LowJit::~M6502LowJit()
+{
+#ifdef JIT_X86_64
+  if(myCode != 0)
+  {
+    munmap(myCode, ourCodeSize);
+  }
+#endif
+  delete[] myBlocks;
+  delete[] myBlockGeneration;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502LowJit::install(System& system)
+{
+  M6502LowJump::install(system);
+
+  // Like the decoded instructions, nothing is translated until a page's
+  // generation has been recorded
+  delete[] myBlocks;
+  delete[] myBlockGeneration;
+  myBlocks = new Block[myAddressMask + 1];
+  myBlockGeneration = new uInt32[system.numberOfPages()];
+  for(uInt32 page = 0; page < system.numberOfPages(); ++page)
+  {
+    myBlockGeneration[page] = 0;
+  }
+  flushBlocks();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+const char* M6502LowJit::name() const
+{
+  return "M6502LowJit";
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool M6502LowJit::executeUntil(uInt32 number, uInt32 targetCycle)
+{
+  // Blocks don't count the instructions they run so leave that to the
+  // interpreter, along with hosts there's no translator for
+  if((myCode == 0) || (number != 0xFFFFFFFF))
+  {
+    return M6502LowJump::executeUntil(number, targetCycle);
+  }
+
+  // Clear all of the execution status bits except for the fatal error bit
+  myExecutionStatus &= FatalErrorBit;
+  myTargetCycle = targetCycle;
+  myIdleLoopDeadline = targetCycle;
+
+  // Loop until execution is stopped or a fatal error occurs
+  for(;;)
+  {
+    while(!myExecutionStatus && (mySystem->cycles() < targetCycle))
+    {
+      uInt16 address = PC & myAddressMask;
+      uInt16 page = address >> myPageShift;
+
+      const System::PageAccess& access = mySystem->getPageAccess(page);
+      if(myBlockGeneration[page] != access.generation)
+      {
+        flushBlockPage(page, access.generation);
+      }
+
+      Block block = myBlocks[address];
+      if((block == 0) && (access.type == System::PageROM))
+      {
+        block = translate(address);
+      }
+
+      if(block != 0)
+      {
+        block(this);
+      }
+      else
+      {
+        // Code in RAM or I/O, or running onto the next page, is interpreted
+        uInt16 operandFetched = fetch();
+        (this->*ourInstructionTable[IR])(operandFetched);
+      }
+    }
+
+    // See if we need to handle an interrupt
+    if((myExecutionStatus & MaskableInterruptBit) || 
+        (myExecutionStatus & NonmaskableInterruptBit))
+    {
+      // Yes, so handle the interrupt
+      interruptHandler();
+    }
+
+    // See if execution has been stopped
+    if(myExecutionStatus & StopExecutionBit)
+    {
+      // Yes, so answer that everything finished fine
+      return true;
+    }
+
+    // See if a fatal error has occured
+    if(myExecutionStatus & FatalErrorBit)
+    {
+      // Yes, so answer that something when wrong
+      return false;
+    }
+
+    // See if we've reached the target cycle
+    if(mySystem->cycles() >= targetCycle)
+    {
+      // Yes, so answer that everything finished fine
+      return true;
+    }
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+template<int opcode>
+bool M6502LowJit::instruction(uInt16 operandFetched)
+{
+  uInt16 operandAddress = 0;
+  uInt8 operand = 0;
+
+  // Only the case for this opcode is kept by the compiler
+  switch(opcode)
+  {
+    // 6502 instruction emulation is generated by an M4 macro file
+    #include "M6502Low.ins"
+
+    default:
+      // Oops, illegal instruction executed so set fatal error flag
+      myExecutionStatus |= FatalErrorBit;
+      cerr << "Illegal Instruction! " << hex << (int) IR << endl;
+  }
+
+  M6502_TRACE_INSTRUCTION();
+
+  return !myExecutionStatus && (mySystem->cycles() < myTargetCycle);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+template<int opcode>
+bool M6502LowJit::compiled(M6502LowJit* cpu, uInt32 fetched, uInt32 length)
+{
+  // Leave things as fetch() would have, including the data bus
+  cpu->IR = opcode;
+  cpu->PC += length;
+  cpu->mySystem->incrementCycles(cpu->myInstructionSystemCycleTable[opcode]);
+  cpu->mySystem->setDataBusState(fetched >> 16);
+
+  return cpu->instruction<opcode>((uInt16)fetched);
+}
+
+// Handlers for a row of sixteen opcodes
+#define JIT_ROW(_function, _row) \
+    _function<_row + 0x0>, _function<_row + 0x1>, _function<_row + 0x2>, \
+    _function<_row + 0x3>, _function<_row + 0x4>, _function<_row + 0x5>, \
+    _function<_row + 0x6>, _function<_row + 0x7>, _function<_row + 0x8>, \
+    _function<_row + 0x9>, _function<_row + 0xa>, _function<_row + 0xb>, \
+    _function<_row + 0xc>, _function<_row + 0xd>, _function<_row + 0xe>, \
+    _function<_row + 0xf>
+
+#define JIT_TABLE(_function) \
+    JIT_ROW(_function, 0x00), JIT_ROW(_function, 0x10), \
+    JIT_ROW(_function, 0x20), JIT_ROW(_function, 0x30), \
+    JIT_ROW(_function, 0x40), JIT_ROW(_function, 0x50), \
+    JIT_ROW(_function, 0x60), JIT_ROW(_function, 0x70), \
+    JIT_ROW(_function, 0x80), JIT_ROW(_function, 0x90), \
+    JIT_ROW(_function, 0xa0), JIT_ROW(_function, 0xb0), \
+    JIT_ROW(_function, 0xc0), JIT_ROW(_function, 0xd0), \
+    JIT_ROW(_function, 0xe0), JIT_ROW(_function, 0xf0)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+const M6502LowJit::Handler M6502LowJit::ourCompiledTable[256] = {
+  JIT_TABLE(&M6502LowJit::compiled)
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+const M6502LowJit::Instruction M6502LowJit::ourInstructionTable[256] = {
+  JIT_TABLE(&M6502LowJit::instruction)
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Answers true if the instruction can change PC, so it has to end a block
+static bool endsBlock(uInt8 opcode)
+{
+  switch(opcode)
+  {
+    case 0x00:    // BRK
+    case 0x10:    // BPL
+    case 0x20:    // JSR
+    case 0x30:    // BMI
+    case 0x40:    // RTI
+    case 0x4c:    // JMP
+    case 0x50:    // BVC
+    case 0x60:    // RTS
+    case 0x6c:    // JMP (indirect)
+    case 0x70:    // BVS
+    case 0x90:    // BCC
+    case 0xb0:    // BCS
+    case 0xd0:    // BNE
+    case 0xf0:    // BEQ
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+M6502LowJit::Block M6502LowJit::translate(uInt16 address)
+{
+#ifdef JIT_X86_64
+  uInt16 page = address >> myPageShift;
+  const System::PageAccess& access = mySystem->getPageAccess(page);
+
+  // Reading ROM has no side effects (other than on the data bus, which
+  // the handlers take care of) so the bytes are taken straight from it
+  const uInt8* rom = access.directPeekBase;
+  uInt32 offset = address & myPageMask;
+
+  // Make sure the longest block fits
+  if(myCodeUsed + ourMaxBlockCode > ourCodeSize)
+  {
+    flushBlocks();
+  }
+  uInt32 start = myCodeUsed;
+
+  // The exits whose rel32 still has to be pointed at the epilogue
+  uInt32 exits[ourMaxBlockInstructions * 2];
+  uInt32 numberOfExits = 0;
+
+  // push rbx; mov rbx, rdi  (keep the processor across the calls)
+  emitByte(0x53);
+  emitByte(0x48); emitByte(0x89); emitByte(0xfb);
+
+  uInt32 count;
+  for(count = 0; count < ourMaxBlockInstructions; ++count)
+  {
+    uInt8 opcode = rom[offset];
+    uInt32 bytes = ourOperandBytesTable[opcode];
+
+    // An instruction running onto the next page is left to the
+    // interpreter since that page can be remapped on its own
+    if(offset + bytes > myPageMask)
+    {
+      break;
+    }
+
+    uInt32 fetched = 0;
+    if(bytes >= 1)
+    {
+      fetched = rom[offset + 1];
+    }
+    if(bytes == 2)
+    {
+      fetched |= (uInt32)rom[offset + 2] << 8;
+    }
+    fetched |= (uInt32)rom[offset + bytes] << 16;
+
+    // mov rdi, rbx; mov esi, fetched; mov edx, length
+    emitByte(0x48); emitByte(0x89); emitByte(0xdf);
+    emitByte(0xbe); emitInt32(fetched);
+    emitByte(0xba); emitInt32(bytes + 1);
+
+    // mov rax, handler; call rax
+    emitByte(0x48); emitByte(0xb8);
+    emitPointer((const void*)ourCompiledTable[opcode]);
+    emitByte(0xff); emitByte(0xd0);
+
+    offset += bytes + 1;
+    if(endsBlock(opcode) || (offset > myPageMask))
+    {
+      ++count;
+      break;
+    }
+
+    // test al, al; jz exit  (stopped, or the deadline has passed)
+    emitByte(0x84); emitByte(0xc0);
+    emitByte(0x0f); emitByte(0x84);
+    exits[numberOfExits++] = myCodeUsed;
+    emitInt32(0);
+
+    // mov rax, &generation; cmp dword [rax], generation; jne exit
+    // (the instruction switched the bank this block comes from)
+    emitByte(0x48); emitByte(0xb8);
+    emitPointer(&access.generation);
+    emitByte(0x81); emitByte(0x38); emitInt32(access.generation);
+    emitByte(0x0f); emitByte(0x85);
+    exits[numberOfExits++] = myCodeUsed;
+    emitInt32(0);
+  }
+
+  // Nothing worth translating if the first instruction can't be
+  if(count == 0)
+  {
+    myCodeUsed = start;
+    return 0;
+  }
+
+  // pop rbx; ret
+  for(uInt32 i = 0; i < numberOfExits; ++i)
+  {
+    uInt32 rel = myCodeUsed - (exits[i] + 4);
+    memcpy(myCode + exits[i], &rel, 4);
+  }
+  emitByte(0x5b);
+  emitByte(0xc3);
+
+  Block block = (Block)(myCode + start);
+  myBlocks[address] = block;
+  return block;
+#else
+  return 0;
+#endif
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502LowJit::flushBlocks()
+{
+  for(uInt32 address = 0; address <= myAddressMask; ++address)
+  {
+    myBlocks[address] = 0;
+  }
+  myCodeUsed = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502LowJit::flushBlockPage(uInt16 page, uInt32 generation)
+{
+  // The code stays allocated until the whole buffer is flushed
+  Block* blocks = &myBlocks[page << myPageShift];
+  for(uInt32 offset = 0; offset <= myPageMask; ++offset)
+  {
+    blocks[offset] = 0;
+  }
+  myBlockGeneration[page] = generation;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502LowJit::emitByte(uInt8 value)
+{
+  myCode[myCodeUsed++] = value;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502LowJit::emitInt32(uInt32 value)
+{
+  memcpy(myCode + myCodeUsed, &value, 4);
+  myCodeUsed += 4;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502LowJit::emitPointer(const void* pointer)
+{
+  memcpy(myCode + myCodeUsed, &pointer, sizeof(pointer));
+  myCodeUsed += sizeof(pointer);
+}
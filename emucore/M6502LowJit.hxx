@@ -0,0 +1,163 @@
+//============================================================================
+//
+// MM     MM  6666  555555  0000   2222
+// MMMM MMMM 66  66 55     00  00 22  22
+// MM MMM MM 66     55     00  00     22
+// MM  M  MM 66666  55555  00  00  22222  --  "A 6502 Microprocessor Emulator"
+// MM     MM 66  66     55 00  00 22
+// MM     MM 66  66 55  55 00  00 22
+// MM     MM  6666   5555   0000  222222
+//
+// Copyright (c) 1995-1998 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#ifndef M6502LOWJIT_HXX
+#define M6502LOWJIT_HXX
+
+class M6502LowJit;
+
+#include "bspf.hxx"
+#include "M6502LowJump.hxx"
+
+/**
+  This class provides the same low compatibility 6502 microprocessor
+  emulation as M6502Low, translating the code it runs from ROM pages
+  into x86-64 code one basic block at a time.
+
+  A translated block is a straight run of calls, one per instruction, to
+  the handler for its opcode with the operand already decoded.  The
+  handlers are instantiated from M6502Low.ins, so they charge cycles and
+  access the TIA, M6532 and cartridge exactly like the interpreter does.
+  Execution leaves a block as soon as a handler stops it, the cycle
+  deadline passes or the block's page is remapped.  Code outside ROM
+  pages is interpreted.
+
+  Execution by instruction count, and hosts other than x86-64 with a
+  unix mmap, use the M6502LowJump interpreter.
+
+  @version $Id$
+*/
+class M6502LowJit : public M6502LowJump
+{
+  public:
+    /**
+      Create a new low compatibility 6502 microprocessor with the specified 
+      cycle multiplier.
+
+      @param systemCyclesPerProcessorCycle The cycle multiplier
+    */
+    M6502LowJit(uInt32 systemCyclesPerProcessorCycle);
+
+    /**
+      Destructor
+    */
+    virtual ~M6502LowJit();
+
+  public:
+    /**
+      Install the processor in the specified system.  Invoked by the
+      system when the processor is attached to it.
+
+      @param system The system the processor should install itself in
+    */
+    virtual void install(System& system);
+
+    /**
+      Get a null terminated string which is the processors's name (i.e. "M6532")
+
+      @return The name of the device
+    */
+    virtual const char* name() const;
+
+  protected:
+    /**
+      Runs translated blocks until the target cycle, or interprets when
+      an instruction count is given.
+
+      @param number Indicates the number of instructions to execute
+      @param targetCycle The system cycle to stop at
+      @return true iff execution stops normally
+    */
+    virtual bool executeUntil(uInt32 number, uInt32 targetCycle);
+
+  private:
+    // Translated code for a block, called with the processor
+    typedef void (*Block)(M6502LowJit* cpu);
+
+    // Handler called by translated code for an instruction
+    typedef bool (*Handler)(M6502LowJit* cpu, uInt32 fetched, uInt32 length);
+
+    // Handler used to interpret an instruction after fetch()
+    typedef bool (M6502LowJit::*Instruction)(uInt16 operandFetched);
+
+    /**
+      Execute the body of an instruction whose opcode and operand have
+      been fetched.
+
+      @param operandFetched The instruction's operand
+      @return true iff execution of the block can go on
+    */
+    template<int opcode> bool instruction(uInt16 operandFetched);
+
+    /**
+      Do what fetch() does for a translated instruction, then execute it.
+
+      @param cpu The processor
+      @param fetched The operand, with the last byte fetched in bits 16-23
+      @param length The number of bytes in the instruction
+      @return true iff execution of the block can go on
+    */
+    template<int opcode> static bool compiled(M6502LowJit* cpu,
+        uInt32 fetched, uInt32 length);
+
+    /**
+      Translate the block starting at the specified address.
+
+      @param address The masked address of the block
+      @return The translated block, or 0 if it can't be translated
+    */
+    Block translate(uInt16 address);
+
+    /**
+      Forget every translated block and reuse their code memory
+    */
+    void flushBlocks();
+
+    /**
+      Forget the translated blocks starting in the specified page.
+
+      @param page The page that has been remapped
+      @param generation The generation number of the page's new mapping
+    */
+    void flushBlockPage(uInt16 page, uInt32 generation);
+
+    // Append x86-64 code to the block being translated
+    void emitByte(uInt8 value);
+    void emitInt32(uInt32 value);
+    void emitPointer(const void* pointer);
+
+  private:
+    // Executable memory holding the translated code, 0 if there's none
+    uInt8* myCode;
+
+    // Bytes of myCode used so far
+    uInt32 myCodeUsed;
+
+    // Translated block starting at each masked address, or 0
+    Block* myBlocks;
+
+    // Generation number of the mapping the blocks of each page came from
+    uInt32* myBlockGeneration;
+
+    // Cycle at which the running blocks have to give up
+    uInt32 myTargetCycle;
+
+    static const Handler ourCompiledTable[256];
+    static const Instruction ourInstructionTable[256];
+};
+#endif
@@ -0,0 +1,182 @@
+//============================================================================
+//
+// MM     MM  6666  555555  0000   2222
+// MMMM MMMM 66  66 55     00  00 22  22
+// MM MMM MM 66     55     00  00     22
+// MM  M  MM 66666  55555  00  00  22222  --  "A 6502 Microprocessor Emulator"
+// MM     MM 66  66     55 00  00 22
+// MM     MM 66  66 55  55 00  00 22
+// MM     MM  6666   5555   0000  222222
+//
+// Copyright (c) 1995-1998 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#include "M6502LowJump.hxx"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+M6502LowJump::M6502LowJump(uInt32 systemCyclesPerProcessorCycle)
+    : M6502Low(systemCyclesPerProcessorCycle)
+{
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+M6502LowJump::~M6502LowJump()
+{
+}
+
+#if defined(__GNUC__)
+
+// Every instruction from M6502Low.ins gets a label, and finishes by
+// fetching and jumping to the next instruction itself
+#define INSTRUCTION(_opcode) lab_##_opcode:
+#define END_INSTRUCTION goto next
+
+// Operands come from fetch() rather than from memory
+#define FETCH_BYTE() ((uInt8)operandFetched)
+#define FETCH_WORD(_dest) _dest = operandFetched
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool M6502LowJump::executeUntil(uInt32 number, uInt32 targetCycle)
+{
+  // Address of the code emulating each of the opcodes
+  static const void* const ourJumpTable[256] = {
+    &&lab_0x00, &&lab_0x01, &&lab_0x02, &&lab_0x03, &&lab_0x04, &&lab_0x05, &&lab_0x06, &&lab_0x07,
+    &&lab_0x08, &&lab_0x09, &&lab_0x0a, &&lab_0x0b, &&lab_0x0c, &&lab_0x0d, &&lab_0x0e, &&lab_0x0f,
+    &&lab_0x10, &&lab_0x11, &&lab_0x12, &&lab_0x13, &&lab_0x14, &&lab_0x15, &&lab_0x16, &&lab_0x17,
+    &&lab_0x18, &&lab_0x19, &&lab_0x1a, &&lab_0x1b, &&lab_0x1c, &&lab_0x1d, &&lab_0x1e, &&lab_0x1f,
+    &&lab_0x20, &&lab_0x21, &&lab_0x22, &&lab_0x23, &&lab_0x24, &&lab_0x25, &&lab_0x26, &&lab_0x27,
+    &&lab_0x28, &&lab_0x29, &&lab_0x2a, &&lab_0x2b, &&lab_0x2c, &&lab_0x2d, &&lab_0x2e, &&lab_0x2f,
+    &&lab_0x30, &&lab_0x31, &&lab_0x32, &&lab_0x33, &&lab_0x34, &&lab_0x35, &&lab_0x36, &&lab_0x37,
+    &&lab_0x38, &&lab_0x39, &&lab_0x3a, &&lab_0x3b, &&lab_0x3c, &&lab_0x3d, &&lab_0x3e, &&lab_0x3f,
+    &&lab_0x40, &&lab_0x41, &&lab_0x42, &&lab_0x43, &&lab_0x44, &&lab_0x45, &&lab_0x46, &&lab_0x47,
+    &&lab_0x48, &&lab_0x49, &&lab_0x4a, &&lab_0x4b, &&lab_0x4c, &&lab_0x4d, &&lab_0x4e, &&lab_0x4f,
+    &&lab_0x50, &&lab_0x51, &&lab_0x52, &&lab_0x53, &&lab_0x54, &&lab_0x55, &&lab_0x56, &&lab_0x57,
+    &&lab_0x58, &&lab_0x59, &&lab_0x5a, &&lab_0x5b, &&lab_0x5c, &&lab_0x5d, &&lab_0x5e, &&lab_0x5f,
+    &&lab_0x60, &&lab_0x61, &&lab_0x62, &&lab_0x63, &&lab_0x64, &&lab_0x65, &&lab_0x66, &&lab_0x67,
+    &&lab_0x68, &&lab_0x69, &&lab_0x6a, &&lab_0x6b, &&lab_0x6c, &&lab_0x6d, &&lab_0x6e, &&lab_0x6f,
+    &&lab_0x70, &&lab_0x71, &&lab_0x72, &&lab_0x73, &&lab_0x74, &&lab_0x75, &&lab_0x76, &&lab_0x77,
+    &&lab_0x78, &&lab_0x79, &&lab_0x7a, &&lab_0x7b, &&lab_0x7c, &&lab_0x7d, &&lab_0x7e, &&lab_0x7f,
+    &&lab_0x80, &&lab_0x81, &&lab_0x82, &&lab_0x83, &&lab_0x84, &&lab_0x85, &&lab_0x86, &&lab_0x87,
+    &&lab_0x88, &&lab_0x89, &&lab_0x8a, &&lab_0x8b, &&lab_0x8c, &&lab_0x8d, &&lab_0x8e, &&lab_0x8f,
+    &&lab_0x90, &&lab_0x91, &&lab_0x92, &&lab_0x93, &&lab_0x94, &&lab_0x95, &&lab_0x96, &&lab_0x97,
+    &&lab_0x98, &&lab_0x99, &&lab_0x9a, &&lab_0x9b, &&lab_0x9c, &&lab_0x9d, &&lab_0x9e, &&lab_0x9f,
+    &&lab_0xa0, &&lab_0xa1, &&lab_0xa2, &&lab_0xa3, &&lab_0xa4, &&lab_0xa5, &&lab_0xa6, &&lab_0xa7,
+    &&lab_0xa8, &&lab_0xa9, &&lab_0xaa, &&lab_0xab, &&lab_0xac, &&lab_0xad, &&lab_0xae, &&lab_0xaf,
+    &&lab_0xb0, &&lab_0xb1, &&lab_0xb2, &&lab_0xb3, &&lab_0xb4, &&lab_0xb5, &&lab_0xb6, &&lab_0xb7,
+    &&lab_0xb8, &&lab_0xb9, &&lab_0xba, &&lab_0xbb, &&lab_0xbc, &&lab_0xbd, &&lab_0xbe, &&lab_0xbf,
+    &&lab_0xc0, &&lab_0xc1, &&lab_0xc2, &&lab_0xc3, &&lab_0xc4, &&lab_0xc5, &&lab_0xc6, &&lab_0xc7,
+    &&lab_0xc8, &&lab_0xc9, &&lab_0xca, &&lab_0xcb, &&lab_0xcc, &&lab_0xcd, &&lab_0xce, &&lab_0xcf,
+    &&lab_0xd0, &&lab_0xd1, &&lab_0xd2, &&lab_0xd3, &&lab_0xd4, &&lab_0xd5, &&lab_0xd6, &&lab_0xd7,
+    &&lab_0xd8, &&lab_0xd9, &&lab_0xda, &&lab_0xdb, &&lab_0xdc, &&lab_0xdd, &&lab_0xde, &&lab_0xdf,
+    &&lab_0xe0, &&lab_0xe1, &&lab_0xe2, &&lab_0xe3, &&lab_0xe4, &&lab_0xe5, &&lab_0xe6, &&lab_0xe7,
+    &&lab_0xe8, &&lab_0xe9, &&lab_0xea, &&lab_0xeb, &&lab_0xec, &&lab_0xed, &&lab_0xee, &&lab_0xef,
+    &&lab_0xf0, &&lab_0xf1, &&lab_0xf2, &&lab_0xf3, &&lab_0xf4, &&lab_0xf5, &&lab_0xf6, &&lab_0xf7,
+    &&lab_0xf8, &&lab_0xf9, &&lab_0xfa, &&lab_0xfb, &&lab_0xfc, &&lab_0xfd, &&lab_0xfe, &&lab_0xff
+  };
+
+  // Clear all of the execution status bits except for the fatal error bit
+  myExecutionStatus &= FatalErrorBit;
+
+  // Skipped loop iterations aren't counted as executed instructions
+  myIdleLoopDeadline = (number == 0xFFFFFFFF) ? targetCycle : 0;
+
+  // Loop until execution is stopped or a fatal error occurs
+  for(;;)
+  {
+    uInt16 operandAddress = 0;
+    uInt8 operand = 0;
+    uInt16 operandFetched;
+
+    if(!myExecutionStatus && (number != 0) &&
+        (mySystem->cycles() < targetCycle))
+    {
+      // Get the instruction and update system cycles
+      operandFetched = fetch();
+
+      goto *ourJumpTable[IR];
+
+      // 6502 instruction emulation is generated by an M4 macro file
+      #include "M6502Low.ins"
+
+lab_0x02:
+lab_0x12:
+lab_0x22:
+lab_0x32:
+lab_0x42:
+lab_0x52:
+lab_0x62:
+lab_0x72:
+lab_0x92:
+lab_0xb2:
+lab_0xd2:
+lab_0xf2:
+        // Oops, illegal instruction executed so set fatal error flag
+        myExecutionStatus |= FatalErrorBit;
+        cerr << "Illegal Instruction! " << hex << (int) IR << endl;
+
+      next:
+        M6502_TRACE_INSTRUCTION();
+
+        if(!myExecutionStatus && (--number != 0) &&
+            (mySystem->cycles() < targetCycle))
+        {
+          // Get the instruction and update system cycles
+          operandFetched = fetch();
+
+          goto *ourJumpTable[IR];
+        }
+    }
+
+    // See if we need to handle an interrupt
+    if((myExecutionStatus & MaskableInterruptBit) || 
+        (myExecutionStatus & NonmaskableInterruptBit))
+    {
+      // Yes, so handle the interrupt
+      interruptHandler();
+    }
+
+    // See if execution has been stopped
+    if(myExecutionStatus & StopExecutionBit)
+    {
+      // Yes, so answer that everything finished fine
+      return true;
+    }
+
+    // See if a fatal error has occured
+    if(myExecutionStatus & FatalErrorBit)
+    {
+      // Yes, so answer that something when wrong
+      return false;
+    }
+
+    // See if we've executed the specified number of instructions or
+    // reached the target cycle
+    if((number == 0) || (mySystem->cycles() >= targetCycle))
+    {
+      // Yes, so answer that everything finished fine
+      return true;
+    }
+  }
+}
+
+#else
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool M6502LowJump::executeUntil(uInt32 number, uInt32 targetCycle)
+{
+  // No computed goto with this compiler so use the switch based loop
+  return M6502Low::executeUntil(number, targetCycle);
+}
+
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+const char* M6502LowJump::name() const
+{
+  return "M6502LowJump";
+}
@@ -0,0 +1,75 @@
+//============================================================================
+//
+// MM     MM  6666  555555  0000   2222
+// MMMM MMMM 66  66 55     00  00 22  22
+// MM MMM MM 66     55     00  00     22
+// MM  M  MM 66666  55555  00  00  22222  --  "A 6502 Microprocessor Emulator"
+// MM     MM 66  66     55 00  00 22
+// MM     MM 66  66 55  55 00  00 22
+// MM     MM  6666   5555   0000  222222
+//
+// Copyright (c) 1995-1998 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#ifndef M6502LOWJUMP_HXX
+#define M6502LOWJUMP_HXX
+
+class M6502LowJump;
+
+#include "bspf.hxx"
+#include "M6502Low.hxx"
+
+/**
+  This class provides the same low compatibility 6502 microprocessor
+  emulation as M6502Low, but dispatches instructions with a computed
+  goto table instead of a switch.  Each instruction jumps straight to the
+  next one, which saves the bounds check and the shared indirect branch
+  of the switch on every instruction.
+
+  The instructions come from the same M6502Low.ins file as M6502Low so
+  both cores always behave identically.  Compilers without the GCC
+  "labels as values" extension get the switch based loop.
+
+  @version $Id$
+*/
+class M6502LowJump : public M6502Low
+{
+  public:
+    /**
+      Create a new low compatibility 6502 microprocessor with the specified 
+      cycle multiplier.
+
+      @param systemCyclesPerProcessorCycle The cycle multiplier
+    */
+    M6502LowJump(uInt32 systemCyclesPerProcessorCycle);
+
+    /**
+      Destructor
+    */
+    virtual ~M6502LowJump();
+
+  public:
+    /**
+      Get a null terminated string which is the processors's name (i.e. "M6532")
+
+      @return The name of the device
+    */
+    virtual const char* name() const;
+
+  protected:
+    /**
+      The threaded version of the execution loop behind execute() and
+      executeCycles().
+
+      @param number Indicates the number of instructions to execute
+      @param targetCycle The system cycle to stop at
+      @return true iff execution stops normally
+    */
+    virtual bool executeUntil(uInt32 number, uInt32 targetCycle);
+};
+#endif
@@ -0,0 +1,379 @@
+//============================================================================
+//
+// MM     MM  6666  555555  0000   2222
+// MMMM MMMM 66  66 55     00  00 22  22
+// MM MMM MM 66     55     00  00     22
+// MM  M  MM 66666  55555  00  00  22222  --  "A 6502 Microprocessor Emulator"
+// MM     MM 66  66     55 00  00 22
+// MM     MM 66  66 55  55 00  00 22
+// MM     MM  6666   5555   0000  222222
+//
+// Copyright (c) 1995-1998 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#ifdef M6502_TRACE
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <algorithm>
+#include "Cart.hxx"
+#include "M6502Profiler.hxx"
+#include "System.hxx"
+
+// Instructions kept per bank, one per address of the 6507's 8K space
+static const uInt32 ourBankSize = 8192;
+
+// Number of loops shown with their disassembly
+static const uInt32 ourDisassembledLoops = 5;
+
+// Host time between samples in microseconds
+static const uInt32 ourSampleInterval = 1000;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+M6502Profiler::M6502Profiler(System& system)
+    : mySystem(system),
+      myBank(0),
+      myPC(0),
+      myPCKnown(false),
+      myLastCycles(system.cycles())
+{
+  memset(&ourIdle, 0, sizeof(ourIdle));
+  ourCurrent = &ourIdle;
+
+#ifdef ITIMER_PROF
+  signal(SIGPROF, sample);
+
+  struct itimerval timer;
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = ourSampleInterval;
+  timer.it_value = timer.it_interval;
+  setitimer(ITIMER_PROF, &timer, 0);
+#endif
+
+  mySystem.m6502().setTracer(this);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+M6502Profiler::~M6502Profiler()
+{
+  mySystem.m6502().setTracer(0);
+
+#ifdef ITIMER_PROF
+  struct itimerval timer;
+  memset(&timer, 0, sizeof(timer));
+  setitimer(ITIMER_PROF, &timer, 0);
+  signal(SIGPROF, SIG_DFL);
+#endif
+  ourCurrent = &ourIdle;
+
+  for(uInt32 bank = 0; bank < myBanks.size(); ++bank)
+  {
+    delete[] myBanks[bank];
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502Profiler::instruction(uInt8 ir, uInt16 pc, uInt8, uInt8, uInt8,
+    uInt8, uInt8, uInt32 cycles)
+{
+  if(myPCKnown)
+  {
+    Instruction& code = at(myBank, myPC);
+
+    // The TIA resets the cycle counter at the start of each frame
+    code.cycles += (cycles >= myLastCycles) ? cycles - myLastCycles : cycles;
+    code.executions++;
+
+    // Keep the operand for the disassembly, if it can be read without side
+    // effects and the instruction didn't switch its own bank away
+    if(!code.operandKnown && (bankAt(myPC) == myBank))
+    {
+      code.opcode = ir;
+      code.operandKnown = true;
+      for(uInt16 i = 0; i < 2; ++i)
+      {
+        uInt16 address = (myPC + 1 + i) & mySystem.addressMask();
+        const System::PageAccess& access =
+            mySystem.getPageAccess(address >> mySystem.pageShift());
+        if(access.directPeekBase == 0)
+        {
+          code.operandKnown = false;
+          break;
+        }
+        code.operand[i] = access.directPeekBase[address & mySystem.pageMask()];
+      }
+    }
+
+    // Branches and jumps going backward close a loop
+    if((((ir & 0x1f) == 0x10) || (ir == 0x4c) || (ir == 0x6c)) &&
+        ((pc & 0x1fff) <= (myPC & 0x1fff)) && (bankAt(pc) == myBank))
+    {
+      uInt16 start = pc & 0x1fff;
+      uInt16 end = myPC & 0x1fff;
+      LoopKey key = ((LoopKey)myBank << 32) | ((LoopKey)start << 16) | end;
+
+      std::map<LoopKey, Loop>::iterator loop = myLoops.find(key);
+      if(loop == myLoops.end())
+      {
+        Loop newLoop = { myBank, start, end, 0 };
+        loop = myLoops.insert(std::make_pair(key, newLoop)).first;
+      }
+      loop->second.iterations++;
+    }
+  }
+
+  myPC = pc;
+  myPCKnown = true;
+  myBank = bankAt(pc);
+  myLastCycles = cycles;
+  ourCurrent = &at(myBank, myPC);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502Profiler::access(uInt16, uInt8, bool, uInt32)
+{
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+M6502Profiler::Instruction& M6502Profiler::at(uInt32 bank, uInt16 address)
+{
+  if(bank >= myBanks.size())
+  {
+    myBanks.resize(bank + 1, 0);
+  }
+  if(myBanks[bank] == 0)
+  {
+    myBanks[bank] = new Instruction[ourBankSize];
+    memset(myBanks[bank], 0, ourBankSize * sizeof(Instruction));
+  }
+  return myBanks[bank][address & (ourBankSize - 1)];
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 M6502Profiler::bankAt(uInt16 address) const
+{
+  if((address & 0x1000) == 0)
+  {
+    return 0;
+  }
+
+  // The upper half of the address space always belongs to the cartridge
+  const System::PageAccess& access = mySystem.getPageAccess(
+      (address & mySystem.addressMask()) >> mySystem.pageShift());
+  return static_cast<const Cartridge*>(access.device)->currentBank(address) + 1;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502Profiler::sample(int)
+{
+  ourCurrent->samples++;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502Profiler::bankName(ostream& out, uInt32 bank) const
+{
+  char name[16];
+  if(bank == 0)
+    sprintf(name, "ram ");
+  else
+    sprintf(name, "b%-3u", bank - 1);
+  out << name;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502Profiler::disassemble(ostream& out, uInt16 address,
+    const Instruction& code) const
+{
+  char text[32];
+  const char* mnemonic = M6502::ourInstructionMnemonicTable[code.opcode];
+  uInt16 word = code.operand[0] | ((uInt16)code.operand[1] << 8);
+  uInt8 byte = code.operand[0];
+
+  if(!code.operandKnown)
+  {
+    M6502::AddressingMode mode = mySystem.m6502().addressingMode(code.opcode);
+    sprintf(text, "%-4s %s", mnemonic,
+        (mode == M6502::Implied) || (mode == M6502::Invalid) ? "" : "??");
+    out << text;
+    return;
+  }
+
+  switch(mySystem.m6502().addressingMode(code.opcode))
+  {
+    case M6502::Absolute:
+      sprintf(text, "%-4s $%04x", mnemonic, word); break;
+    case M6502::AbsoluteX:
+      sprintf(text, "%-4s $%04x,X", mnemonic, word); break;
+    case M6502::AbsoluteY:
+      sprintf(text, "%-4s $%04x,Y", mnemonic, word); break;
+    case M6502::Immediate:
+      sprintf(text, "%-4s #$%02x", mnemonic, byte); break;
+    case M6502::Indirect:
+      sprintf(text, "%-4s ($%04x)", mnemonic, word); break;
+    case M6502::IndirectX:
+      sprintf(text, "%-4s ($%02x,X)", mnemonic, byte); break;
+    case M6502::IndirectY:
+      sprintf(text, "%-4s ($%02x),Y", mnemonic, byte); break;
+    case M6502::Relative:
+      sprintf(text, "%-4s $%04x", mnemonic,
+          (uInt16)(address + 2 + (Int8)byte) & 0x1fff); break;
+    case M6502::Zero:
+      sprintf(text, "%-4s $%02x", mnemonic, byte); break;
+    case M6502::ZeroX:
+      sprintf(text, "%-4s $%02x,X", mnemonic, byte); break;
+    case M6502::ZeroY:
+      sprintf(text, "%-4s $%02x,Y", mnemonic, byte); break;
+    default:
+      sprintf(text, "%-4s", mnemonic); break;
+  }
+  out << text;
+}
+
+// Orders instructions and loops by the cycles spent on them
+struct ProfileEntry
+{
+  unsigned long long cycles;
+  uInt32 samples;
+  uInt32 bank;
+  uInt16 address;
+  uInt32 loop;    // Index of the loop, for loops
+};
+
+static bool profileHotter(const ProfileEntry& a, const ProfileEntry& b)
+{
+  return a.cycles > b.cycles;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502Profiler::report(ostream& out, uInt32 count) const
+{
+  char line[128];
+
+  // Totals, per bank and overall
+  std::vector<ProfileEntry> banks, instructions;
+  unsigned long long totalCycles = 0;
+  uInt32 totalSamples = ourIdle.samples;
+  for(uInt32 bank = 0; bank < myBanks.size(); ++bank)
+  {
+    if(myBanks[bank] == 0)
+      continue;
+
+    ProfileEntry entry = { 0, 0, bank, 0, 0 };
+    for(uInt32 address = 0; address < ourBankSize; ++address)
+    {
+      const Instruction& code = myBanks[bank][address];
+      if(code.executions == 0)
+        continue;
+
+      ProfileEntry instruction = { code.cycles, code.samples, bank, address, 0 };
+      instructions.push_back(instruction);
+      entry.cycles += code.cycles;
+      entry.samples += code.samples;
+    }
+    banks.push_back(entry);
+    totalCycles += entry.cycles;
+    totalSamples += entry.samples;
+  }
+  double cyclesScale = totalCycles ? 100.0 / totalCycles : 0.0;
+  double samplesScale = totalSamples ? 100.0 / totalSamples : 0.0;
+
+  sprintf(line, "%llu cycles, %u host samples of %u us%s\n\n", totalCycles,
+      totalSamples, ourSampleInterval,
+      totalSamples ? "" : " (no profiling timer on this host)");
+  out << line;
+
+  out << "bank      cycles  cycles%  host%\n";
+  for(uInt32 i = 0; i < banks.size(); ++i)
+  {
+    bankName(out, banks[i].bank);
+    sprintf(line, " %11llu  %6.2f%%  %5.1f%%\n", banks[i].cycles,
+        banks[i].cycles * cyclesScale, banks[i].samples * samplesScale);
+    out << line;
+  }
+
+  // The hottest instructions
+  std::sort(instructions.begin(), instructions.end(), profileHotter);
+  out << "\nhottest instructions\n";
+  out << "bank addr  executions      cycles  cycles%  host%  instruction\n";
+  for(uInt32 i = 0; (i < count) && (i < instructions.size()); ++i)
+  {
+    const ProfileEntry& entry = instructions[i];
+    const Instruction& code = myBanks[entry.bank][entry.address];
+    bankName(out, entry.bank);
+    sprintf(line, " %04x  %10u %11llu  %6.2f%%  %5.1f%%  ", entry.address,
+        code.executions, code.cycles, code.cycles * cyclesScale,
+        code.samples * samplesScale);
+    out << line;
+    disassemble(out, entry.address, code);
+    out << "\n";
+  }
+
+  // The hottest loops, charged with everything between their start and end
+  std::vector<Loop> loops;
+  std::vector<ProfileEntry> hotLoops;
+  for(std::map<LoopKey, Loop>::const_iterator i = myLoops.begin();
+      i != myLoops.end(); ++i)
+  {
+    const Loop& loop = i->second;
+    ProfileEntry entry = { 0, 0, loop.bank, loop.start, (uInt32)loops.size() };
+    for(uInt32 address = loop.start; address <= loop.end; ++address)
+    {
+      entry.cycles += myBanks[loop.bank][address].cycles;
+      entry.samples += myBanks[loop.bank][address].samples;
+    }
+    loops.push_back(loop);
+    hotLoops.push_back(entry);
+  }
+  std::sort(hotLoops.begin(), hotLoops.end(), profileHotter);
+
+  out << "\nhottest loops\n";
+  out << "bank start-end  iterations      cycles  cycles%  host%\n";
+  for(uInt32 i = 0; (i < count) && (i < hotLoops.size()); ++i)
+  {
+    const ProfileEntry& entry = hotLoops[i];
+    const Loop& loop = loops[entry.loop];
+    bankName(out, loop.bank);
+    sprintf(line, " %04x-%04x %10u %11llu  %6.2f%%  %5.1f%%\n", loop.start,
+        loop.end, loop.iterations, entry.cycles, entry.cycles * cyclesScale,
+        entry.samples * samplesScale);
+    out << line;
+  }
+
+  for(uInt32 i = 0; (i < ourDisassembledLoops) && (i < hotLoops.size()); ++i)
+  {
+    const Loop& loop = loops[hotLoops[i].loop];
+    out << "\nloop ";
+    bankName(out, loop.bank);
+    sprintf(line, " %04x-%04x\n", loop.start, loop.end);
+    out << line;
+
+    for(uInt32 address = loop.start; address <= loop.end; ++address)
+    {
+      const Instruction& code = myBanks[loop.bank][address];
+      if(code.executions == 0)
+        continue;
+
+      sprintf(line, "  %04x  %10u %11llu  %6.2f%%  %5.1f%%  ", address,
+          code.executions, code.cycles, code.cycles * cyclesScale,
+          code.samples * samplesScale);
+      out << line;
+      disassemble(out, address, code);
+      out << "\n";
+    }
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+M6502Profiler::Instruction* volatile M6502Profiler::ourCurrent = 0;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+M6502Profiler::Instruction M6502Profiler::ourIdle;
+
+#endif
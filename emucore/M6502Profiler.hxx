@@ -0,0 +1,163 @@
+//============================================================================
+//
+// MM     MM  6666  555555  0000   2222
+// MMMM MMMM 66  66 55     00  00 22  22
+// MM MMM MM 66     55     00  00     22
+// MM  M  MM 66666  55555  00  00  22222  --  "A 6502 Microprocessor Emulator"
+// MM     MM 66  66     55 00  00 22
+// MM     MM 66  66 55  55 00  00 22
+// MM     MM  6666   5555   0000  222222
+//
+// Copyright (c) 1995-1998 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#ifndef M6502PROFILER_HXX
+#define M6502PROFILER_HXX
+
+#ifdef M6502_TRACE
+
+class M6502Profiler;
+
+#include <map>
+#include <vector>
+#include "bspf.hxx"
+#include "M6502.hxx"
+
+/**
+  Guest profiler: accumulates the system cycles spent on each instruction
+  of the 6502 program, told apart by cartridge bank, along with samples
+  of the host time spent on them where the host has a profiling timer
+  (ITIMER_PROF).  Backward branches and jumps are counted as loops.  The
+  report lists the banks, the hottest instructions and a disassembly of
+  the hottest loops.
+
+  The cycles charged to an instruction include whatever it made the
+  processor wait, such as a WSYNC or a skipped idle loop.  The host time
+  includes the cost of the profiling itself, which is about the same for
+  every instruction.
+
+  Built on the M6502_TRACE hooks, so it only exists in builds defining
+  M6502_TRACE.  Only one profiler can sample the host time at a time.
+
+  @version $Id$
+*/
+class M6502Profiler : public M6502Tracer
+{
+  public:
+    /**
+      Create a profiler for the processor of the specified system, and
+      start sampling the host time.
+
+      @param system The system whose processor is profiled
+    */
+    M6502Profiler(System& system);
+
+    /**
+      Destructor, stops sampling the host time
+    */
+    virtual ~M6502Profiler();
+
+  public:
+    /**
+      Charge the cycles since the previous instruction to this one.
+    */
+    virtual void instruction(uInt8 ir, uInt16 pc, uInt8 a, uInt8 x, uInt8 y,
+        uInt8 sp, uInt8 ps, uInt32 cycles);
+
+    /**
+      Accesses aren't profiled
+    */
+    virtual void access(uInt16 address, uInt8 value, bool write,
+        uInt32 cycles);
+
+    /**
+      Write the report.
+
+      @param out The stream to write the report to
+      @param count The number of instructions and loops listed
+    */
+    void report(ostream& out, uInt32 count = 20) const;
+
+  private:
+    // What's known about an instruction of the program
+    struct Instruction
+    {
+      unsigned long long cycles;
+      uInt32 executions;
+      uInt32 samples;   // Host time samples taken while it was running
+      uInt8 opcode;
+      uInt8 operand[2];
+      bool operandKnown;
+    };
+
+    // A loop, from the target of a backward branch or jump to that
+    // branch or jump
+    struct Loop
+    {
+      uInt32 bank;
+      uInt16 start;
+      uInt16 end;
+      uInt32 iterations;
+    };
+
+    // Key of the loop map: bank, start and end
+    typedef unsigned long long LoopKey;
+
+    /**
+      Get the instruction at the specified address of the specified bank,
+      allocating the bank as needed.
+    */
+    Instruction& at(uInt32 bank, uInt16 address);
+
+    /**
+      Get the bank of the program the specified address reads from: 0
+      outside the cartridge, the cartridge's bank plus 1 in it.
+    */
+    uInt32 bankAt(uInt16 address) const;
+
+    /**
+      Write the disassembly of an instruction.
+    */
+    void disassemble(ostream& out, uInt16 address,
+        const Instruction& instruction) const;
+
+    /**
+      Write the name of a bank.
+    */
+    void bankName(ostream& out, uInt32 bank) const;
+
+    /**
+      Host profiling timer handler, charges a sample to ourCurrent.
+    */
+    static void sample(int signal);
+
+  private:
+    System& mySystem;
+
+    // Instructions of each bank, 0 until the bank runs something
+    std::vector<Instruction*> myBanks;
+
+    std::map<LoopKey, Loop> myLoops;
+
+    // Where the instruction being run comes from
+    uInt32 myBank;
+    uInt16 myPC;
+    bool myPCKnown;
+
+    // System cycle counter after the previous instruction
+    uInt32 myLastCycles;
+
+    // Instruction charged with the host time samples
+    static Instruction* volatile ourCurrent;
+
+    // Sample taken when there's no instruction to charge yet
+    static Instruction ourIdle;
+};
+
+#endif
+#endif
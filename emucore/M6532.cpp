@@ -22,6 +22,8 @@
 #include "Random.hxx"
 #include "Switches.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include <iostream>
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -101,18 +103,55 @@ void M6532::install(System& system)
       {
         access.directPeekBase = &myRAM[address & 0x007f];
         access.directPokeBase = &myRAM[address & 0x007f];
+        access.type = System::PageRAM;
         mySystem->setPageAccess(address >> shift, access);
       }
       else
       {
         access.directPeekBase = 0; 
         access.directPokeBase = 0;
+        access.type = System::PageRIOT;
         mySystem->setPageAccess(address >> shift, access);
       }
     }
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool M6532::save(Serializer& out)
+{
+  out.putString(name());
+
+  out.putBytes(myRAM, sizeof(myRAM));
+  out.putInt(myTimer);
+  out.putInt(myIntervalShift);
+  out.putInt(myCyclesWhenTimerSet);
+  out.putInt(myCyclesWhenInterruptReset);
+  out.putBool(myTimerReadAfterInterrupt);
+  out.putByte(myDDRA);
+  out.putByte(myDDRB);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool M6532::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  in.getBytes(myRAM, sizeof(myRAM));
+  myTimer = in.getInt();
+  myIntervalShift = in.getInt();
+  myCyclesWhenTimerSet = (Int32)in.getInt();
+  myCyclesWhenInterruptReset = (Int32)in.getInt();
+  myTimerReadAfterInterrupt = in.getBool();
+  myDDRA = in.getByte();
+  myDDRB = in.getByte();
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 M6532::peek(uInt16 addr)
 {
@@ -215,6 +254,40 @@ uInt8 M6532::peek(uInt16 addr)
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool M6532::peekIdle(uInt16 addr, uInt32 cycle, uInt8& value,
+    uInt32& nextChange)
+{
+  // Only the timer changes by itself (the ports change between frames)
+  if((addr & 0x04) == 0)
+  {
+    return false;
+  }
+
+  // Same as the timer read in peek() up to the interrupt
+  uInt32 delta = (cycle - 1) - myCyclesWhenTimerSet;
+  Int32 timer = (Int32)myTimer - (Int32)(delta >> myIntervalShift) - 1;
+  if(timer < 0)
+  {
+    return false;
+  }
+
+  if(addr & 0x01)
+  {
+    // Interrupt flag stays clear until the timer expires
+    value = 0x00;
+    nextChange = myCyclesWhenTimerSet + (myTimer << myIntervalShift) + 1;
+  }
+  else
+  {
+    // Timer output counts down once per interval
+    value = (uInt8)timer;
+    nextChange = myCyclesWhenTimerSet +
+        (((delta >> myIntervalShift) + 1) << myIntervalShift) + 1;
+  }
+  return true;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void M6532::poke(uInt16 addr, uInt8 value)
 {
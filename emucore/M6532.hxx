@@ -74,6 +74,22 @@ class M6532 : public Device
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
    public:
     /**
       Get the byte at the specified address
@@ -82,6 +98,19 @@ class M6532 : public Device
     */
     virtual uInt8 peek(uInt16 address);
 
+    /**
+      Predict reads of the timer and its interrupt flag until the timer
+      expires (the first read after that has a side effect).
+
+      @param address The address being polled
+      @param cycle The system cycle of the read
+      @param value Set to the byte read
+      @param nextChange Set to the cycle at which the byte may change
+      @return true iff reading the address can be predicted
+    */
+    virtual bool peekIdle(uInt16 address, uInt32 cycle, uInt8& value,
+        uInt32& nextChange);
+
     /**
       Change the byte at the specified address to the given value
 
@@ -44,14 +44,28 @@ class MediaSource
     */
     virtual ~MediaSource();
 
+  public:
+    /**
+      Formats of the pixels a media source can draw
+    */
+    enum PixelFormat
+    {
+      Indexed8,   // One byte palette index per pixel
+      RGB565,     // 16-bit 5:6:5 RGB pixels
+      RGB888      // 32-bit 0x00RRGGBB pixels
+    };
+
   public:
     /**
       This method should be called at an interval corresponding to the 
       desired frame rate to update the media source.  Invoking this method
       will update the graphics buffer and generate the corresponding audio
       samples.
+
+      @param draw False to run the frame without drawing it; everything
+                  but the graphics buffer is updated as usual
     */
-    virtual void update() = 0;
+    virtual void update(bool draw = true) = 0;
 
     /**
       Toggle between the available palettes.  The frontends will need to
@@ -73,6 +87,28 @@ class MediaSource
     */
     virtual uInt8* previousFrameBuffer() const = 0;
 
+    /**
+      Draw the frames straight into the given buffer instead of the
+      internal ones, so the frontend can display it without a copy.
+
+      @param buffer The buffer to draw into, which must hold 300 lines of
+                    palette indices or height() lines of RGB pixels, or the
+                    null pointer to use the internal buffers again
+      @param pitch  The number of bytes from one line to the next
+      @param format The format of the pixels in the buffer
+    */
+    virtual void setOutputBuffer(uInt8* buffer, uInt32 pitch, 
+        PixelFormat format = Indexed8) = 0;
+
+    /**
+      Hold back the register writes which only change what's drawn and
+      draw each scanline once they're all known, instead of drawing up to
+      every write as it happens.  The frames are the same either way.
+
+      @param enable Whether the writes should be held back
+    */
+    virtual void setCatchUpRendering(bool enable) = 0;
+
   public:
     /**
       Get the palette which maps frame data to RGB values.
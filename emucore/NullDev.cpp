@@ -17,6 +17,8 @@
 //============================================================================
 
 #include "NullDev.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 NullDevice::NullDevice()
@@ -45,6 +47,23 @@ void NullDevice::install(System& system)
   mySystem = &system;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool NullDevice::save(Serializer& out)
+{
+  out.putString(name());
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool NullDevice::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 NullDevice::peek(uInt16 address)
 {
@@ -0,0 +1,244 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll       
+//  SS  SS   tt           ll   ll        
+//  SS     tttttt  eeee   ll   ll   aaaa 
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2005 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#include <string.h>
+#include "Console.hxx"
+#include "Deserializer.hxx"
+#include "RewindBuffer.hxx"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+RewindBuffer::RewindBuffer(uInt32 size, uInt32 frames)
+    : myBuffer(0),
+      mySize(size),
+      myRecords(0),
+      myMaxRecords(BSPF_max(frames, 1u)),
+      myFirst(0),
+      myCount(0),
+      myState(0),
+      myStateSize(0),
+      myStateCapacity(0)
+{
+  myBuffer = new uInt8[mySize];
+  myRecords = new Record[myMaxRecords];
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+RewindBuffer::~RewindBuffer()
+{
+  delete[] myBuffer;
+  delete[] myRecords;
+  delete[] myState;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RewindBuffer::clear()
+{
+  myFirst = myCount = 0;
+  myStateSize = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 RewindBuffer::used() const
+{
+  uInt32 total = 0;
+  for(uInt32 i = 0; i < myCount; ++i)
+    total += myRecords[(myFirst + i) % myMaxRecords].size;
+
+  return total;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool RewindBuffer::capture(Console& console)
+{
+  mySnapshot.reset();
+  if(!console.saveState(mySnapshot))
+    return false;
+
+  uInt32 size = mySnapshot.size();
+
+  // The first snapshot, or one that can't be diffed against the previous
+  // one, starts a new history
+  if(size != myStateSize)
+  {
+    if(size > myStateCapacity)
+    {
+      delete[] myState;
+      myStateCapacity = size;
+      myState = new uInt32[(myStateCapacity + 3) / 4];
+    }
+    memcpy(myState, mySnapshot.data(), size);
+    myStateSize = size;
+    myFirst = myCount = 0;
+    return true;
+  }
+
+  // Worst case: one token per changed word plus the trailing bytes
+  uInt8* out = reserve(4 + 2 * size + 4);
+  if(out == 0)
+  {
+    memcpy(myState, mySnapshot.data(), size);
+    myFirst = myCount = 0;
+    return false;
+  }
+
+  Record& record = myRecords[(myFirst + myCount) % myMaxRecords];
+  record.offset = out - myBuffer;
+  record.size = encode(mySnapshot.data(), out);
+  ++myCount;
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool RewindBuffer::rewind(Console& console)
+{
+  if(myCount == 0)
+    return false;
+
+  --myCount;
+  decode(myBuffer + myRecords[(myFirst + myCount) % myMaxRecords].offset);
+
+  Deserializer in((const uInt8*)myState, myStateSize);
+  return console.loadState(in);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt8* RewindBuffer::reserve(uInt32 length)
+{
+  if(length > mySize)
+    return 0;
+
+  // Deltas are laid out one after the other, wrapping to the start of the
+  // buffer when the next one might not fit before the end
+  uInt32 offset = 0;
+  if(myCount > 0)
+  {
+    const Record& newest = myRecords[(myFirst + myCount - 1) % myMaxRecords];
+    offset = newest.offset + newest.size;
+  }
+
+  if(offset + length > mySize)
+  {
+    // The records between the newest one and the end of the buffer are
+    // the oldest ones, so they go first
+    while((myCount > 0) && (myRecords[myFirst].offset >= offset))
+    {
+      myFirst = (myFirst + 1) % myMaxRecords;
+      --myCount;
+    }
+    offset = 0;
+  }
+
+  // Drop the oldest records until the new one doesn't overlap any of them
+  while(myCount > 0)
+  {
+    const Record& oldest = myRecords[myFirst];
+    if((myCount < myMaxRecords) &&
+       ((oldest.offset >= offset + length) ||
+        (oldest.offset + oldest.size <= offset)))
+      break;
+
+    myFirst = (myFirst + 1) % myMaxRecords;
+    --myCount;
+  }
+
+  return myBuffer + offset;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 RewindBuffer::encode(const uInt8* snapshot, uInt8* out)
+{
+  const uInt32* in = (const uInt32*)snapshot;
+  uInt32* state = myState;
+  uInt32 words = myStateSize / 4;
+  uInt8* start = out;
+
+  uInt32 i = 0;
+  while(i < words)
+  {
+    // Skip the words which haven't changed, a block at a time while
+    // whole blocks are identical
+    uInt32 skip = 0;
+    while((i + 64 <= words) && (skip <= 0xffff - 64) &&
+          (memcmp(state + i, in + i, 256) == 0))
+    {
+      i += 64;
+      skip += 64;
+    }
+    while((i < words) && (state[i] == in[i]) && (skip < 0xffff))
+    {
+      ++i;
+      ++skip;
+    }
+
+    // Followed by the changed ones, up to the next unchanged word
+    uInt8* token = out;
+    out += 4;
+    uInt32 count = 0;
+    while((i < words) && (state[i] != in[i]) && (count < 0xffff))
+    {
+      uInt32 delta = state[i] ^ in[i];
+      memcpy(out, &delta, 4);
+      out += 4;
+      state[i] = in[i];
+      ++i;
+      ++count;
+    }
+
+    token[0] = skip & 0xff;
+    token[1] = skip >> 8;
+    token[2] = count & 0xff;
+    token[3] = count >> 8;
+  }
+
+  // The bytes which don't fill a whole word
+  uInt8* stateBytes = (uInt8*)myState;
+  for(uInt32 j = words * 4; j < myStateSize; ++j)
+  {
+    *out++ = stateBytes[j] ^ snapshot[j];
+    stateBytes[j] = snapshot[j];
+  }
+
+  return out - start;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RewindBuffer::decode(const uInt8* in)
+{
+  uInt32* state = myState;
+  uInt32 words = myStateSize / 4;
+
+  uInt32 i = 0;
+  while(i < words)
+  {
+    i += in[0] | (in[1] << 8);
+    uInt32 count = in[2] | (in[3] << 8);
+    in += 4;
+
+    for(; count > 0; --count, ++i, in += 4)
+    {
+      uInt32 delta;
+      memcpy(&delta, in, 4);
+      state[i] ^= delta;
+    }
+  }
+
+  uInt8* stateBytes = (uInt8*)myState;
+  for(uInt32 j = words * 4; j < myStateSize; ++j)
+    stateBytes[j] ^= *in++;
+}
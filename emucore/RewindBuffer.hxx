@@ -0,0 +1,142 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll       
+//  SS  SS   tt           ll   ll        
+//  SS     tttttt  eeee   ll   ll   aaaa 
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2005 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#ifndef REWINDBUFFER_HXX
+#define REWINDBUFFER_HXX
+
+class Console;
+
+#include "bspf.hxx"
+#include "Serializer.hxx"
+
+/**
+  This class keeps the recent history of a console so the game can be
+  stepped back frame by frame.
+
+  Only the newest snapshot is kept in full.  Every older one is stored as
+  the XOR of itself and the snapshot that followed it, with the runs of
+  unchanged words squeezed out.  Most of the machine is identical from one
+  frame to the next, so a frame usually costs a few hundred bytes.  The
+  deltas live in a fixed size byte ring and the oldest ones are dropped
+  once it is full.
+
+  Delta layout, in 32-bit words:  a sequence of (uInt16 skip, uInt16 count,
+  count XOR words) tokens covering the whole snapshot, followed by the XOR
+  of the trailing size % 4 bytes.
+
+  @version $Id$
+*/
+class RewindBuffer
+{
+  public:
+    /**
+      Create a new rewind buffer
+
+      @param size   The number of bytes kept for the deltas
+      @param frames The maximum number of frames which can be stepped back
+    */
+    RewindBuffer(uInt32 size = 512 * 1024, uInt32 frames = 18000);
+
+    /**
+      Destructor
+    */
+    virtual ~RewindBuffer();
+
+  public:
+    /**
+      Snapshot the console and push the previous snapshot into the
+      history.  Should be called once after each Console::update().
+
+      @param console The console to snapshot
+      @return False on any errors, else true
+    */
+    bool capture(Console& console);
+
+    /**
+      Step the console back to the previous snapshot.
+
+      @param console The console to restore
+      @return False if there is no history left or on errors, else true
+    */
+    bool rewind(Console& console);
+
+    /**
+      Forget the whole history, e.g. when another game is loaded
+    */
+    void clear();
+
+    /**
+      Answers the number of frames which can currently be stepped back
+
+      @return The number of frames
+    */
+    uInt32 frames() const { return myCount; }
+
+    /**
+      Answers the number of bytes used by the deltas
+
+      @return The number of bytes
+    */
+    uInt32 used() const;
+
+  private:
+    // Make room for a delta of at most length bytes and answer where it goes
+    uInt8* reserve(uInt32 length);
+
+    // XOR encode the snapshot against myState, which becomes the snapshot
+    uInt32 encode(const uInt8* snapshot, uInt8* out);
+
+    // Apply a delta to myState, which becomes the previous snapshot
+    void decode(const uInt8* in);
+
+  private:
+    // Location of a delta in the byte ring
+    struct Record
+    {
+      uInt32 offset;
+      uInt32 size;
+    };
+
+    // Byte ring the deltas are stored in
+    uInt8* myBuffer;
+    uInt32 mySize;
+
+    // Ring of records, oldest first
+    Record* myRecords;
+    uInt32 myMaxRecords;
+    uInt32 myFirst;
+    uInt32 myCount;
+
+    // Newest snapshot, in full (allocated as words so it can be XORed
+    // a word at a time)
+    uInt32* myState;
+    uInt32 myStateSize;
+    uInt32 myStateCapacity;
+
+    // Scratch buffer each snapshot is taken into
+    Serializer mySnapshot;
+
+  private:
+    // Copy constructor isn't supported by this class so make it private
+    RewindBuffer(const RewindBuffer&);
+
+    // Assignment operator isn't supported by this class so make it private
+    RewindBuffer& operator = (const RewindBuffer&);
+};
+
+#endif
@@ -0,0 +1,108 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll       
+//  SS  SS   tt           ll   ll        
+//  SS     tttttt  eeee   ll   ll   aaaa 
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2005 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#include <string.h>
+#include "Serializer.hxx"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Serializer::Serializer(uInt32 capacity)
+    : myBuffer(0),
+      mySize(0),
+      myCapacity(BSPF_max(capacity, 16u))
+{
+  myBuffer = new uInt8[myCapacity];
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Serializer::~Serializer()
+{
+  delete[] myBuffer;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::reset()
+{
+  mySize = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::reserve(uInt32 length)
+{
+  if(mySize + length <= myCapacity)
+    return;
+
+  while(mySize + length > myCapacity)
+    myCapacity *= 2;
+
+  uInt8* buffer = new uInt8[myCapacity];
+  memcpy(buffer, myBuffer, mySize);
+  delete[] myBuffer;
+  myBuffer = buffer;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::putByte(uInt8 value)
+{
+  reserve(1);
+  myBuffer[mySize++] = value;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::putShort(uInt16 value)
+{
+  reserve(2);
+  myBuffer[mySize++] = value & 0xff;
+  myBuffer[mySize++] = value >> 8;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::putInt(uInt32 value)
+{
+  reserve(4);
+  myBuffer[mySize++] = value & 0xff;
+  myBuffer[mySize++] = (value >> 8) & 0xff;
+  myBuffer[mySize++] = (value >> 16) & 0xff;
+  myBuffer[mySize++] = value >> 24;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::putBool(bool b)
+{
+  putByte(b ? 1 : 0);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::putDouble(double value)
+{
+  putBytes((const uInt8*)&value, sizeof(double));
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::putString(const string& str)
+{
+  putShort(str.length());
+  putBytes((const uInt8*)str.data(), str.length());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::putBytes(const uInt8* buf, uInt32 length)
+{
+  reserve(length);
+  memcpy(myBuffer + mySize, buf, length);
+  mySize += length;
+}
@@ -0,0 +1,137 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll       
+//  SS  SS   tt           ll   ll        
+//  SS     tttttt  eeee   ll   ll   aaaa 
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2005 by Bradford W. Mott
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+// $Id$
+//============================================================================
+
+#ifndef SERIALIZER_HXX
+#define SERIALIZER_HXX
+
+#include "bspf.hxx"
+
+/**
+  This class implements a compact binary output buffer which is used to
+  save the state of the emulated machine.  The state is built in memory so
+  a complete snapshot costs little more than a few memory copies; the
+  caller decides if it should then be written to a file, kept in a rewind
+  buffer, compared against another snapshot, ...
+
+  Multi-byte values are always stored in little-endian order so snapshots
+  are portable between hosts.
+
+  @version $Id$
+*/
+class Serializer
+{
+  public:
+    /**
+      Create a new, empty serializer
+
+      @param capacity The initial size of the buffer in bytes
+    */
+    Serializer(uInt32 capacity = 65536);
+
+    /**
+      Destructor
+    */
+    virtual ~Serializer();
+
+  public:
+    /**
+      Discard everything written so far, keeping the allocated buffer
+    */
+    void reset();
+
+    /**
+      Answers the bytes written so far
+
+      @return Pointer to the start of the buffer
+    */
+    const uInt8* data() const { return myBuffer; }
+
+    /**
+      Answers the number of bytes written so far
+
+      @return The size of the data in bytes
+    */
+    uInt32 size() const { return mySize; }
+
+  public:
+    /**
+      Writes a byte value to the buffer
+
+      @param value The byte value to write
+    */
+    void putByte(uInt8 value);
+
+    /**
+      Writes a 16-bit value to the buffer
+
+      @param value The short value to write
+    */
+    void putShort(uInt16 value);
+
+    /**
+      Writes a 32-bit value to the buffer
+
+      @param value The integer value to write
+    */
+    void putInt(uInt32 value);
+
+    /**
+      Writes a boolean value to the buffer
+
+      @param b The boolean value to write
+    */
+    void putBool(bool b);
+
+    /**
+      Writes a double value to the buffer (in the host representation)
+
+      @param value The double value to write
+    */
+    void putDouble(double value);
+
+    /**
+      Writes a string to the buffer
+
+      @param str The string to write
+    */
+    void putString(const string& str);
+
+    /**
+      Writes a block of bytes to the buffer
+
+      @param buf The bytes to write
+      @param length The number of bytes to write
+    */
+    void putBytes(const uInt8* buf, uInt32 length);
+
+  private:
+    // Make sure there's room for the given number of extra bytes
+    void reserve(uInt32 length);
+
+  private:
+    // The buffer holding the serialized data
+    uInt8* myBuffer;
+
+    // The number of bytes used in the buffer
+    uInt32 mySize;
+
+    // The number of bytes allocated for the buffer
+    uInt32 myCapacity;
+};
+
+#endif
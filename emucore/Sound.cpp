@@ -17,6 +17,9 @@
 //============================================================================
 
 #include "Sound.hxx"
+#include "TIASound.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Sound::Sound(uInt32 fragsize)
@@ -57,6 +60,11 @@ bool Sound::isSuccessfullyInitialized() const
   return true;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Sound::processFrame()
+{
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Sound::reset()
 {
@@ -79,3 +87,39 @@ void Sound::adjustVolume(Int8 direction)
 }
 
 
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Sound::save(Serializer& out)
+{
+  out.putString("TIASound");
+
+  uInt8 reg[6];
+  Tia_get_registers(&reg[0], &reg[1], &reg[2], &reg[3], &reg[4], &reg[5]);
+  out.putBytes(reg, 6);
+  out.putInt(myLastRegisterSetCycle);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Sound::load(Deserializer& in)
+{
+  if(in.getString() != "TIASound")
+    return false;
+
+  uInt8 reg[6];
+  in.getBytes(reg, 6);
+  Int32 cycle = (Int32)in.getInt();
+  if(!in.isValid())
+    return false;
+
+  // AUDC0, AUDC1, AUDF0, AUDF1, AUDV0, AUDV1
+  set(0x15, reg[0], cycle);
+  set(0x16, reg[1], cycle);
+  set(0x17, reg[2], cycle);
+  set(0x18, reg[3], cycle);
+  set(0x19, reg[4], cycle);
+  set(0x1a, reg[5], cycle);
+
+  return true;
+}
@@ -22,6 +22,8 @@
 class Console;
 class MediaSource;
 class System;
+class Serializer;
+class Deserializer;
 
 #include "bspf.hxx"
 
@@ -84,6 +86,12 @@ class Sound
     */
     virtual void mute(bool state);
 
+    /**
+      Invoked once a frame has been emulated, so the sound device can
+      produce the samples for it.
+    */
+    virtual void processFrame();
+
     /**
       Reset the sound device.
     */
@@ -115,6 +123,23 @@ class Sound
     */
     virtual void adjustVolume(Int8 direction);
 
+    /**
+      Saves the current state of the sound registers to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the sound registers from the given Deserializer.  The registers
+      are written back through set() so the sound device picks them up.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
   protected:
     // The Console for the system
     Console* myConsole;
@@ -18,10 +18,13 @@
 
 //#include <assert.h>
 #include <iostream>
+#include <string.h>
 
 #include "Device.hxx"
 #include "M6502.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 System::System(uInt16 n, uInt16 m)
@@ -32,7 +35,8 @@ System::System(uInt16 n, uInt16 m)
       myNumberOfDevices(0),
       myM6502(0),
       myCycles(0),
-      myDataBusState(0)
+      myDataBusState(0),
+      myPageGeneration(0)
 {
   // Make sure the arguments are reasonable
   //assert((1 <= m) && (m <= n) && (n <= 16));
@@ -86,6 +90,48 @@ void System::reset()
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool System::save(Serializer& out)
+{
+  out.putString("System");
+  out.putInt(myCycles);
+  out.putByte(myDataBusState);
+
+  if(!myM6502->save(out))
+    return false;
+
+  // Now save the state of each device
+  for(uInt32 i = 0; i < myNumberOfDevices; ++i)
+  {
+    if(!myDevices[i]->save(out))
+      return false;
+  }
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool System::load(Deserializer& in)
+{
+  if(in.getString() != "System")
+    return false;
+
+  myCycles = in.getInt();
+  myDataBusState = in.getByte();
+
+  if(!myM6502->load(in))
+    return false;
+
+  // Now load the state of each device
+  for(uInt32 i = 0; i < myNumberOfDevices; ++i)
+  {
+    if(!myDevices[i]->load(in))
+      return false;
+  }
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void System::attach(Device* device)
 {
@@ -130,16 +176,41 @@ void System::setPageAccess(uInt16 page, const PageAccess& access)
   // Make sure the access methods make sense
   //assert(access.device != 0);
 
-  myPageAccessTable[page] = access;
+  PageAccess& current = myPageAccessTable[page];
+
+  // Devices often install the same mapping again (a bank switch to the
+  // bank that's already selected), which leaves the page's code valid
+  uInt32 generation = current.generation;
+  if((current.directPeekBase != access.directPeekBase) ||
+     (current.directPokeBase != access.directPokeBase) ||
+     (current.device != access.device) || (current.type != access.type))
+  {
+    generation = ++myPageGeneration;
+  }
+
+  current = access;
+  current.generation = generation;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-const System::PageAccess& System::getPageAccess(uInt16 page)
+void System::setPageAccess(uInt16 page, uInt16 count,
+    const PageAccess* accesses)
 {
-  // Make sure the page is within range
-  //assert(page <= myNumberOfPages);
+  // Make sure the pages are within range
+  //assert(page + count <= myNumberOfPages);
+
+  memcpy(&myPageAccessTable[page], accesses, count * sizeof(PageAccess));
+}
 
-  return myPageAccessTable[page];
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void System::prepareMappings(PageAccess* accesses, uInt32 count)
+{
+  // A number is never given out twice, so a page holding one of these
+  // accesses holds exactly that mapping
+  for(uInt32 i = 0; i < count; ++i)
+  {
+    accesses[i].generation = ++myPageGeneration;
+  }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
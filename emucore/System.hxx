@@ -22,10 +22,14 @@
 class Device;
 class M6502;
 class NullDevice;
+class Serializer;
+class Deserializer;
 
 #include "bspf.hxx"
 #include "Device.hxx"
 #include "NullDev.hxx"
+#include "TIA.hxx"
+#include "M6532.hxx"
 
 /**
   This class represents a system consisting of a 6502 microprocessor
@@ -37,11 +41,12 @@ class NullDevice;
   In general the addressing space will be 8192 (2^13) bytes for a 
   6507 based system and 65536 (2^16) bytes for a 6502 based system.
 
-  TODO: To allow for dynamic code generation we probably need to
-        add a tag to each page that indicates if it is read only
-        memory.  We also need to notify the processor anytime a
-        page access method is changed so that it can clear the
-        dynamic code for that page of memory.
+  Each page carries a type tag telling what is mapped there, so the
+  processor can tell ROM from RAM and reach the TIA and M6532 without
+  going through the virtual device interface.  Each page also carries a
+  generation number which changes whenever a different mapping is
+  installed in it, so a processor caching decoded code from a page can
+  tell when the cache has gone stale.
 
   @author  Bradford W. Mott
   @version $Id: System.hxx,v 1.3 2002/05/13 19:10:25 stephena Exp $
@@ -70,6 +75,25 @@ class System
     */
     void reset();
 
+    /**
+      Saves the complete state of the system to the given Serializer:
+      the cycle counter, the processor and then every attached device
+      in the order they were attached.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    bool save(Serializer& out);
+
+    /**
+      Loads the complete state of the system from the given Deserializer.
+      The state must have been saved by a system with the same devices.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    bool load(Deserializer& in);
+
   public:
     /**
       Attach the specified device and claim ownership of it.  The device 
@@ -140,6 +164,16 @@ class System
     {
       return myPageMask;
     }
+
+    /**
+      Get the mask applied to an address before accessing memory.
+
+      @return The mask applied to an address before accessing memory
+    */
+    uInt16 addressMask() const
+    {
+      return myAddressMask;
+    }
  
   public:
     /**
@@ -180,6 +214,14 @@ class System
     */  
     uInt8 getDataBusState() const;
 
+    /**
+      Set the current state of the data bus, for a processor which got the
+      bytes of an instruction without reading them through the system.
+
+      @param state The last data accessed
+    */
+    void setDataBusState(uInt8 state);
+
     /**
       Get the byte at the specified address.  No masking of the
       address occurs before it's sent to the device mapped at
@@ -200,11 +242,36 @@ class System
     void poke(uInt16 address, uInt8 value);
 
   public:
+    /**
+      Kind of memory or device mapped into a page
+    */
+    enum PageType
+    {
+      PageDevice,     // Generic device, accessed through its peek/poke
+      PageROM,        // Read only memory, read through directPeekBase
+      PageRAM,        // Read/write memory or one of its read/write ports
+      PageTIA,        // TIA registers, device is the TIA
+      PageRIOT,       // M6532 timer and I/O registers, device is the M6532
+      PageHotspot     // Cartridge bank switching hot spots
+    };
+
     /**
       Structure used to specify access methods for a page
     */
     struct PageAccess
     {
+      /**
+        Create an access structure for a generic device page
+      */
+      PageAccess()
+        : directPeekBase(0),
+          directPokeBase(0),
+          device(0),
+          type(PageDevice),
+          generation(0)
+      {
+      }
+
       /**
         Pointer to a block of memory or the null pointer.  The null pointer
         indicates that the device's peek method should be invoked for reads
@@ -226,6 +293,20 @@ class System
         null device if the page hasn't been mapped to a device
       */
       Device* device;
+
+      /**
+        What is mapped into this page.  For PageTIA and PageRIOT the
+        device is known to be the TIA or M6532, so it's accessed without
+        a virtual call.
+      */
+      PageType type;
+
+      /**
+        Changed by setPageAccess whenever the page gets a different
+        mapping.  Set by the system, whatever the caller passes, except
+        for accesses given their own numbers by prepareMappings.
+      */
+      uInt32 generation;
     };
 
     /**
@@ -236,13 +317,34 @@ class System
     */
     void setPageAccess(uInt16 page, const PageAccess& access);
 
+    /**
+      Set the page accessing methods for a run of pages with a single
+      copy, as cartridges do to switch a whole bank in.  The accesses
+      must have been given their generation numbers by prepareMappings.
+
+      @param page The first page accessing methods should be set for
+      @param count The number of pages
+      @param accesses The accessing methods to be used by the pages
+    */
+    void setPageAccess(uInt16 page, uInt16 count, const PageAccess* accesses);
+
+    /**
+      Give each of the page accesses a generation number of its own, so
+      they can be installed later by setPageAccess(page, count, accesses)
+      without being compared with the current mappings.
+
+      @param accesses The accessing methods to number
+      @param count The number of accessing methods
+    */
+    void prepareMappings(PageAccess* accesses, uInt32 count);
+
     /**
       Get the page accessing method for the specified page.
 
       @param page The page to get accessing methods for
       @return The accessing methods used by the page
     */
-    const PageAccess& getPageAccess(uInt16 page);
+    const PageAccess& getPageAccess(uInt16 page) const;
  
   private:
     // Mask to apply to an address before accessing memory
@@ -278,6 +380,9 @@ class System
     // The current state of the Data Bus
     uInt8 myDataBusState;
 
+    // Last generation number given to a page
+    uInt32 myPageGeneration;
+
   private:
     // Copy constructor isn't supported by this class so make it private
     System(const System&);
@@ -292,6 +397,21 @@ inline uInt8 System::getDataBusState() const
   return myDataBusState;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inline void System::setDataBusState(uInt8 state)
+{
+  myDataBusState = state;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+inline const System::PageAccess& System::getPageAccess(uInt16 page) const
+{
+  // Make sure the page is within range
+  //assert(page <= myNumberOfPages);
+
+  return myPageAccessTable[page];
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 inline uInt8 System::peek(uInt16 addr)
 {
@@ -304,6 +424,14 @@ inline uInt8 System::peek(uInt16 addr)
   {
     result = *(access.directPeekBase + (addr & myPageMask));
   }
+  else if(access.type == PageTIA)
+  {
+    result = static_cast<TIA*>(access.device)->TIA::peek(addr);
+  }
+  else if(access.type == PageRIOT)
+  {
+    result = static_cast<M6532*>(access.device)->M6532::peek(addr);
+  }
   else
   {
     result = access.device->peek(addr);
@@ -324,6 +452,14 @@ inline void System::poke(uInt16 addr, uInt8 value)
   {
     *(access.directPokeBase + (addr & myPageMask)) = value;
   }
+  else if(access.type == PageTIA)
+  {
+    static_cast<TIA*>(access.device)->TIA::poke(addr, value);
+  }
+  else if(access.type == PageRIOT)
+  {
+    static_cast<M6532*>(access.device)->M6532::poke(addr, value);
+  }
   else
   {
     access.device->poke(addr, value);
@@ -24,17 +24,176 @@
 #include "Control.hxx"
 #include "M6502.hxx"
 #include "System.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 #include "TIA.hxx"
 #include "Sound.hxx"
 #define HBLANK 68
 
-extern unsigned char vidBuf[256*256];
+/**
+  Sixteen byte vector primitives used by updateFrameObjects.  Each target
+  provides the same small set of operations; masks are 0xff in the lanes
+  where a condition holds and 0x00 elsewhere.
+*/
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TIA_VECTOR_RENDERER
+
+typedef __m128i Vector;
+
+static inline Vector vecLoad(const uInt8* p)
+{
+  return _mm_loadu_si128((const __m128i*)p);
+}
+
+static inline void vecStore(uInt8* p, Vector v)
+{
+  _mm_storeu_si128((__m128i*)p, v);
+}
+
+static inline Vector vecSet(uInt8 value)
+{
+  return _mm_set1_epi8((char)value);
+}
+
+static inline Vector vecAnd(Vector a, Vector b)
+{
+  return _mm_and_si128(a, b);
+}
+
+static inline Vector vecOr(Vector a, Vector b)
+{
+  return _mm_or_si128(a, b);
+}
+
+static inline Vector vecSelect(Vector mask, Vector a, Vector b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline Vector vecNonZero(Vector v)
+{
+  return _mm_xor_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()),
+                       _mm_set1_epi8((char)0xff));
+}
+
+// Mask of the lanes whose index is less than count (0 <= count <= 16)
+static inline Vector vecFirstLanes(uInt32 count)
+{
+  const __m128i lanes = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                      8, 9, 10, 11, 12, 13, 14, 15);
+  return _mm_cmplt_epi8(lanes, _mm_set1_epi8((char)count));
+}
+
+// Mask of the lanes where (bits & mask[lane]) is non-zero
+static inline Vector vecTest32(const uInt32* mask, uInt32 bits)
+{
+  const __m128i b = _mm_set1_epi32(bits), zero = _mm_setzero_si128();
+  __m128i m0 = _mm_cmpeq_epi32(_mm_and_si128(
+      _mm_loadu_si128((const __m128i*)(mask + 0)), b), zero);
+  __m128i m1 = _mm_cmpeq_epi32(_mm_and_si128(
+      _mm_loadu_si128((const __m128i*)(mask + 4)), b), zero);
+  __m128i m2 = _mm_cmpeq_epi32(_mm_and_si128(
+      _mm_loadu_si128((const __m128i*)(mask + 8)), b), zero);
+  __m128i m3 = _mm_cmpeq_epi32(_mm_and_si128(
+      _mm_loadu_si128((const __m128i*)(mask + 12)), b), zero);
+  __m128i z = _mm_packs_epi16(_mm_packs_epi32(m0, m1), _mm_packs_epi32(m2, m3));
+  return _mm_xor_si128(z, _mm_set1_epi8((char)0xff));
+}
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TIA_VECTOR_RENDERER
+
+typedef uint8x16_t Vector;
+
+static inline Vector vecLoad(const uInt8* p)
+{
+  return vld1q_u8(p);
+}
+
+static inline void vecStore(uInt8* p, Vector v)
+{
+  vst1q_u8(p, v);
+}
+
+static inline Vector vecSet(uInt8 value)
+{
+  return vdupq_n_u8(value);
+}
+
+static inline Vector vecAnd(Vector a, Vector b)
+{
+  return vandq_u8(a, b);
+}
+
+static inline Vector vecOr(Vector a, Vector b)
+{
+  return vorrq_u8(a, b);
+}
+
+static inline Vector vecSelect(Vector mask, Vector a, Vector b)
+{
+  return vbslq_u8(mask, a, b);
+}
+
+static inline Vector vecNonZero(Vector v)
+{
+  return vtstq_u8(v, v);
+}
+
+// Mask of the lanes whose index is less than count (0 <= count <= 16)
+static inline Vector vecFirstLanes(uInt32 count)
+{
+  static const uInt8 lanes[16] = 
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+  return vcltq_u8(vld1q_u8(lanes), vdupq_n_u8((uInt8)count));
+}
+
+// Mask of the lanes where (bits & mask[lane]) is non-zero
+static inline Vector vecTest32(const uInt32* mask, uInt32 bits)
+{
+  const uint32x4_t b = vdupq_n_u32(bits);
+  uint16x8_t lo = vcombine_u16(vmovn_u32(vtstq_u32(vld1q_u32(mask + 0), b)),
+                               vmovn_u32(vtstq_u32(vld1q_u32(mask + 4), b)));
+  uint16x8_t hi = vcombine_u16(vmovn_u32(vtstq_u32(vld1q_u32(mask + 8), b)),
+                               vmovn_u32(vtstq_u32(vld1q_u32(mask + 12), b)));
+  return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+}
+#endif
+
+/**
+  Rotate a line of 160 bits (pixel x in bit x % 32 of word x / 32) to the
+  right of the screen by the given number of pixels, wrapping around.
+*/
+static inline void rotateLine(const uInt32* line, uInt32 pixels, 
+    uInt32* result)
+{
+  uInt32 words = pixels / 32, bits = pixels % 32;
+
+  for(uInt32 i = 0; i < 5; ++i)
+  {
+    uInt32 from = (i + 5 - words) % 5;
+    result[i] = line[from] << bits;
+    if(bits != 0)
+      result[i] |= line[(from + 4) % 5] >> (32 - bits);
+  }
+}
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TIA::TIA(const Console& console, Sound& sound)
     : myConsole(console),
       mySound(sound),
       myColorLossEnabled(false),
+      myOutputBuffer(0),
+      myOutputPitch(0),
+      myOutputFormat(MediaSource::Indexed8),
+      myDrawFrame(true),
+      myLineAboveValid(false),
+      myCatchUpRendering(false),
+      myPendingWriteCount(0),
+      myPendingWritesLineEnd(0),
+      myFramePitch(160),
       myMaximumNumberOfScanlines(262),
       myCOLUBK(myColor[0]),
       myCOLUPF(myColor[1]),
@@ -44,7 +203,6 @@ TIA::TIA(const Console& console, Sound& sound)
   // Allocate buffers for two frame buffers
   myCurrentFrameBuffer = new uInt8[160 * 300];
   myPreviousFrameBuffer = new uInt8[160 * 300];
-  myDSFramePointer = (uInt8 *) &vidBuf;
   
   ourActualPalette = 0;
 
@@ -85,19 +243,16 @@ TIA::TIA(const Console& console, Sound& sound)
     }
   }
 
-  for(uInt32 i = 0; i < 640; ++i)
+  // Compute the mask tables which aren't built into the program, they're
+  // shared by every TIA so this is only done once
+  if(!ourMaskTablesComputed)
   {
-    ourDisabledMaskTable[i] = 0;
+    computeBallMaskTable();
+    computeMissleMaskTable();
+    computePlayerMaskTable();
+    computeObjectLineTables();
+    ourMaskTablesComputed = true;
   }
-
-  // Compute all of the mask tables
-  computeBallMaskTable();
-  computeCollisionTable();
-  computeMissleMaskTable();
-  computePlayerMaskTable();
-  computePlayerPositionResetWhenTable();
-  computePlayerReflectTable();
-  computePlayfieldMaskTable();
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -124,9 +279,20 @@ void TIA::reset()
   {
     myCurrentFrameBuffer[i] = myPreviousFrameBuffer[i] = 0;
   }
+  if(myOutputBuffer != 0)
+  {
+    for(uInt32 line = 0; line < 300; ++line)
+    {
+      if(myOutputFormat == Indexed8)
+        memset(myOutputBuffer + line * myOutputPitch, 0, 160);
+      else if(line < myFrameHeight)
+        convertLine(line);
+    }
+  }
 
   // Reset pixel pointer and drawing flag
-  myFramePointer = myCurrentFrameBuffer;
+  myFramePointer = currentFrameBuffer();
+  myPendingWriteCount = 0;
 
   // Calculate color clock offsets for starting and stoping frame drawing
   myStartDisplayOffset = 228 * 34;
@@ -177,6 +343,12 @@ void TIA::reset()
   myRESMP0 = false;
   myRESMP1 = false;
   myCollision = 0;
+  for(uInt32 j = 0; j < 6; ++j)
+  {
+    myObjectLineMasks[j] = 0;
+  }
+  myObjectLinesEnabled = 0;
+  myLineAboveValid = false;
   myPOSP0 = 0;
   myPOSP1 = 0;
   myPOSM0 = 0;
@@ -224,6 +396,9 @@ void TIA::reset()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIA::systemCyclesReset()
 {
+  // The writes held back use clocks from before the reset
+  flushPendingWrites();
+
   // Get the current system cycle
   uInt32 cycles = mySystem->cycles();
 
@@ -260,6 +435,7 @@ void TIA::install(System& system)
   access.directPeekBase = 0;
   access.directPokeBase = 0;
   access.device = this;
+  access.type = System::PageTIA;
 
   // We're installing in a 2600 system
   for(uInt32 i = 0; i < 8192; i += (1 << shift))
@@ -271,7 +447,7 @@ void TIA::install(System& system)
   }
 }
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::update()
+void TIA::update(bool draw)
 {
 #if 0 // ALEK
   uInt8* tmp = myCurrentFrameBuffer;
@@ -295,11 +471,16 @@ void TIA::update()
   myClocksToEndOfScanLine = 228;
 
   // Reset frame buffer pointer
-  myFramePointer = myCurrentFrameBuffer;
-  myDSFramePointer = (uInt8 *) &vidBuf;
+  myFramePointer = currentFrameBuffer();
+  myDrawFrame = draw;
+  myLineAboveValid = false;
   
-  // Execute instructions until frame is finished
-  mySystem->m6502().execute(25000);
+  // Execute instructions until the frame is finished by VSYNC, or until
+  // the scanline after the one where poke() gives up on VSYNC has passed
+  // for games that stop writing to the TIA
+  mySystem->m6502().executeCycles((myClockWhenFrameStarted +
+      (myMaximumNumberOfScanlines + 2) * 228) / 3);
+  flushPendingWrites();
 
   // Compute the number of scanlines in the frame
   uInt32 totalClocks = (mySystem->cycles() * 3) - myClockWhenFrameStarted;
@@ -338,6 +519,73 @@ uInt32 TIA::height() const
   return myFrameHeight; 
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::setOutputBuffer(uInt8* buffer, uInt32 pitch, PixelFormat format)
+{
+  // The writes held back draw into the buffer they were made for
+  flushPendingWrites();
+
+  // Keep the beam at the same place in the new buffer
+  uInt32 offset = myFramePointer - currentFrameBuffer();
+  uInt32 line = offset / myFramePitch, column = offset % myFramePitch;
+
+  myOutputBuffer = buffer;
+  myOutputPitch = pitch;
+  myOutputFormat = format;
+
+  // Palette indices are drawn straight into the buffer, while the other
+  // formats are drawn into the internal buffer and converted a scanline
+  // at a time
+  myFramePitch = ((buffer != 0) && (format == Indexed8)) ? pitch : 160;
+  myFramePointer = currentFrameBuffer() + line * myFramePitch + column;
+  myLineAboveValid = false;
+
+  computeOutputPalette();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::setCatchUpRendering(bool enable)
+{
+  flushPendingWrites();
+  myCatchUpRendering = enable;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::computeOutputPalette()
+{
+  const uInt32* rgb = palette();
+
+  for(uInt32 i = 0; i < 256; ++i)
+  {
+    uInt32 r = (rgb[i] >> 16) & 0xff, g = (rgb[i] >> 8) & 0xff, b = rgb[i] & 0xff;
+
+    if(myOutputFormat == RGB565)
+      myOutputPalette[i] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    else
+      myOutputPalette[i] = rgb[i] & 0x00ffffff;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::convertLine(uInt32 line)
+{
+  const uInt8* in = myCurrentFrameBuffer + line * 160;
+  uInt8* out = myOutputBuffer + line * myOutputPitch;
+
+  if(myOutputFormat == RGB565)
+  {
+    uInt16* pixel = (uInt16*)out;
+    for(uInt32 x = 0; x < 160; ++x)
+      pixel[x] = (uInt16)myOutputPalette[in[x]];
+  }
+  else
+  {
+    uInt32* pixel = (uInt32*)out;
+    for(uInt32 x = 0; x < 160; ++x)
+      pixel[x] = myOutputPalette[in[x]];
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt32 TIA::scanlines() const
 {
@@ -388,60 +636,6 @@ void TIA::computeBallMaskTable()
   }
 }
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computeCollisionTable()
-{
-  for(uInt8 i = 0; i < 64; ++i)
-  { 
-    ourCollisionTable[i] = 0;
-
-    if((i & myM0Bit) && (i & myP1Bit))    // M0-P1
-      ourCollisionTable[i] |= 0x0001;
-
-    if((i & myM0Bit) && (i & myP0Bit))    // M0-P0
-      ourCollisionTable[i] |= 0x0002;
-
-    if((i & myM1Bit) && (i & myP0Bit))    // M1-P0
-      ourCollisionTable[i] |= 0x0004;
-
-    if((i & myM1Bit) && (i & myP1Bit))    // M1-P1
-      ourCollisionTable[i] |= 0x0008;
-
-    if((i & myP0Bit) && (i & myPFBit))    // P0-PF
-      ourCollisionTable[i] |= 0x0010;
-
-    if((i & myP0Bit) && (i & myBLBit))    // P0-BL
-      ourCollisionTable[i] |= 0x0020;
-
-    if((i & myP1Bit) && (i & myPFBit))    // P1-PF
-      ourCollisionTable[i] |= 0x0040;
-
-    if((i & myP1Bit) && (i & myBLBit))    // P1-BL
-      ourCollisionTable[i] |= 0x0080;
-
-    if((i & myM0Bit) && (i & myPFBit))    // M0-PF
-      ourCollisionTable[i] |= 0x0100;
-
-    if((i & myM0Bit) && (i & myBLBit))    // M0-BL
-      ourCollisionTable[i] |= 0x0200;
-
-    if((i & myM1Bit) && (i & myPFBit))    // M1-PF
-      ourCollisionTable[i] |= 0x0400;
-
-    if((i & myM1Bit) && (i & myBLBit))    // M1-BL
-      ourCollisionTable[i] |= 0x0800;
-
-    if((i & myBLBit) && (i & myPFBit))    // BL-PF
-      ourCollisionTable[i] |= 0x1000;
-
-    if((i & myP0Bit) && (i & myP1Bit))    // P0-P1
-      ourCollisionTable[i] |= 0x2000;
-
-    if((i & myM0Bit) && (i & myM1Bit))    // M0-M1
-      ourCollisionTable[i] |= 0x4000;
-  }
-}
-
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIA::computeMissleMaskTable()
 {
@@ -642,190 +836,135 @@ void TIA::computePlayerMaskTable()
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computePlayerPositionResetWhenTable()
+void TIA::computeObjectLineTables()
 {
-  uInt32 mode, oldx, newx;
-
-  // Loop through all player modes, all old player positions, and all new
-  // player positions and determine where the new position is located:
-  // 1 means the new position is within the display of an old copy of the
-  // player, -1 means the new position is within the delay portion of an
-  // old copy of the player, and 0 means it's neither of these two
-  for(mode = 0; mode < 8; ++mode)
+  memset(ourBallLineTable, 0, sizeof(ourBallLineTable));
+  memset(ourMissleLineTable, 0, sizeof(ourMissleLineTable));
+  memset(ourPlayerLineTable, 0, sizeof(ourPlayerLineTable));
+  memset(ourPlayfieldLineTable, 0, sizeof(ourPlayfieldLineTable));
+
+  // The lines are taken from the alignment 0 masks of an object at
+  // position 0, the other masks are rotations of them
+  for(uInt32 x = 0; x < 160; ++x)
   {
-    for(oldx = 0; oldx < 160; ++oldx)
+    uInt32 word = x / 32, bit = 1 << (x % 32);
+
+    for(uInt32 size = 0; size < 4; ++size)
     {
-      // Set everything to 0 for non-delay/non-display section
-      for(newx = 0; newx < 160; ++newx)
+      if(ourBallMaskTable[0][size][x])
+        ourBallLineTable[size][word] |= bit;
+
+      for(uInt32 number = 0; number < 8; ++number)
       {
-        ourPlayerPositionResetWhenTable[mode][oldx][newx] = 0;
+        if(ourMissleMaskTable[0][number][size][x])
+          ourMissleLineTable[number][size][word] |= bit;
       }
+    }
 
-      // Now, we'll set the entries for non-delay/non-display section
-      for(newx = 0; newx < 160 + 72 + 5; ++newx)
+    // The player and playfield lines are kept for every value of each
+    // nibble of the graphics, so a line takes a few lookups to build
+    for(uInt32 enable = 0; enable < 2; ++enable)
+    {
+      for(uInt32 mode = 0; mode < 8; ++mode)
       {
-        if(mode == 0x00)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x01)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 16)) && (newx < (oldx + 16 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 16 + 4) && (newx < (oldx + 16 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x02)
+        uInt8 mask = ourPlayerMaskTable[0][enable][mode][x];
+        for(uInt32 value = 0; value < 16; ++value)
         {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 32)) && (newx < (oldx + 32 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 32 + 4) && (newx < (oldx + 32 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x03)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 16)) && (newx < (oldx + 16 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 32)) && (newx < (oldx + 32 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 16 + 4) && (newx < (oldx + 16 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 32 + 4) && (newx < (oldx + 32 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x04)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 64)) && (newx < (oldx + 64 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 64 + 4) && (newx < (oldx + 64 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x05)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 16)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x06)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 32)) && (newx < (oldx + 32 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 64)) && (newx < (oldx + 64 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 32 + 4) && (newx < (oldx + 32 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 64 + 4) && (newx < (oldx + 64 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x07)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 32)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+          if(mask & value)
+            ourPlayerLineTable[enable][mode][0][value][word] |= bit;
+          if(mask & (value << 4))
+            ourPlayerLineTable[enable][mode][1][value][word] |= bit;
         }
       }
+    }
 
-      // Let's do a sanity check on our table entries
-      uInt32 s1 = 0, s2 = 0;
-      for(newx = 0; newx < 160; ++newx)
+    for(uInt32 reflect = 0; reflect < 2; ++reflect)
+    {
+      uInt32 mask = ourPlayfieldTable[reflect][x];
+      for(uInt32 nibble = 0; nibble < 5; ++nibble)
       {
-        if(ourPlayerPositionResetWhenTable[mode][oldx][newx] == -1)
-          ++s1;
-        if(ourPlayerPositionResetWhenTable[mode][oldx][newx] == 1)
-          ++s2;
+        for(uInt32 value = 0; value < 16; ++value)
+        {
+          if(mask & (value << (nibble * 4)))
+            ourPlayfieldLineTable[reflect][nibble][value][word] |= bit;
+        }
       }
-      assert((s1 % 4 == 0) && (s2 % 8 == 0));
     }
   }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computePlayerReflectTable()
+void TIA::computeObjectLine(uInt32 object, uInt32* line)
 {
-  for(uInt16 i = 0; i < 256; ++i)
+  uInt32 lines[5] = { 0, 0, 0, 0, 0 };
+  uInt32 offset = 0, align = 0, start = 0;
+
+  // Find which mask of its table the object is using, and where the mask
+  // starts in the 320 pixels of it
+  switch(object)
   {
-    uInt8 r = 0;
+    case 0:   // Player 0
+    case 2:   // Player 1
+    {
+      const uInt8* mask = (object == 0) ? myCurrentP0Mask : myCurrentP1Mask;
+      uInt8 graphics = (object == 0) ? myCurrentGRP0 : myCurrentGRP1;
+
+      offset = mask - &ourPlayerMaskTable[0][0][0][0];
+      uInt32 mode = (offset / 320) % 8, enable = (offset / (320 * 8)) % 2;
+      const uInt32* low = ourPlayerLineTable[enable][mode][0][graphics & 0x0F];
+      const uInt32* high = ourPlayerLineTable[enable][mode][1][graphics >> 4];
+      for(uInt32 w = 0; w < 5; ++w)
+        lines[w] = low[w] | high[w];
+      align = offset / (320 * 16);
+      break;
+    }
 
-    for(uInt16 t = 1; t <= 128; t *= 2)
+    case 1:   // Missle 0
+    case 3:   // Missle 1
     {
-      r = (r << 1) | ((i & t) ? 0x01 : 0x00);
+      const uInt8* mask = (object == 1) ? myCurrentM0Mask : myCurrentM1Mask;
+      if(mask == ourDisabledMaskTable)
+      {
+        memset(line, 0, 5 * sizeof(uInt32));
+        return;
+      }
+
+      offset = mask - &ourMissleMaskTable[0][0][0][0];
+      uInt32 size = (offset / 320) % 4, number = (offset / (320 * 4)) % 8;
+      memcpy(lines, ourMissleLineTable[number][size], sizeof(lines));
+      align = offset / (320 * 32);
+      break;
     }
 
-    ourPlayerReflectTable[i] = r;
-  } 
-}
+    case 4:   // Ball
+    {
+      offset = myCurrentBLMask - &ourBallMaskTable[0][0][0];
+      memcpy(lines, ourBallLineTable[(offset / 320) % 4], sizeof(lines));
+      align = offset / (320 * 4);
+      break;
+    }
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computePlayfieldMaskTable()
-{
-  Int32 x;
+    default:  // Playfield
+    {
+      uInt32 reflect = (myCurrentPFMask == ourPlayfieldTable[0]) ? 0 : 1;
+      for(uInt32 i = 0; i < 5; ++i)
+      {
+        const uInt32* nibble = 
+            ourPlayfieldLineTable[reflect][i][(myPF >> (i * 4)) & 0x0F];
+        for(uInt32 w = 0; w < 5; ++w)
+          lines[w] |= nibble[w];
+      }
 
-  // Compute playfield mask table for non-reflected mode
-  for(x = 0; x < 160; ++x)
-  {
-    if(x < 16)
-      ourPlayfieldTable[0][x] = 0x00001 << (x / 4);
-    else if(x < 48)
-      ourPlayfieldTable[0][x] = 0x00800 >> ((x - 16) / 4);
-    else if(x < 80) 
-      ourPlayfieldTable[0][x] = 0x01000 << ((x - 48) / 4);
-    else if(x < 96) 
-      ourPlayfieldTable[0][x] = 0x00001 << ((x - 80) / 4);
-    else if(x < 128)
-      ourPlayfieldTable[0][x] = 0x00800 >> ((x - 96) / 4);
-    else if(x < 160) 
-      ourPlayfieldTable[0][x] = 0x01000 << ((x - 128) / 4);
+      // The playfield doesn't move
+      memcpy(line, lines, sizeof(lines));
+      return;
+    }
   }
 
-  // Compute playfield mask table for reflected mode
-  for(x = 0; x < 160; ++x)
-  {
-    if(x < 16)
-      ourPlayfieldTable[1][x] = 0x00001 << (x / 4);
-    else if(x < 48)
-      ourPlayfieldTable[1][x] = 0x00800 >> ((x - 16) / 4);
-    else if(x < 80) 
-      ourPlayfieldTable[1][x] = 0x01000 << ((x - 48) / 4);
-    else if(x < 112) 
-      ourPlayfieldTable[1][x] = 0x80000 >> ((x - 80) / 4);
-    else if(x < 144) 
-      ourPlayfieldTable[1][x] = 0x00010 << ((x - 112) / 4);
-    else if(x < 160) 
-      ourPlayfieldTable[1][x] = 0x00008 >> ((x - 144) / 4);
-  }
+  // The mask's pixel x is pixel (start + x - align) of the line at
+  // position 0
+  start = offset % 320;
+  rotateLine(lines, (align + 320 - start) % 160, line);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -858,7 +997,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myPFBit: 
       case myPFBit | PriorityBit:
       {
-        uInt32* mask = &myCurrentPFMask[hpos];
+        const uInt32* mask = &myCurrentPFMask[hpos];
 
         // Update a uInt8 at a time until reaching a uInt32 boundary
         for(; ((uintptr_t)myFramePointer & 0x03) && (myFramePointer < ending);
@@ -879,7 +1018,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myPFBit | ScoreBit:
       case myPFBit | ScoreBit | PriorityBit:
       {
-        uInt32* mask = &myCurrentPFMask[hpos];
+        const uInt32* mask = &myCurrentPFMask[hpos];
 
         // Update a uInt8 at a time until reaching a uInt32 boundary
         for(; ((uintptr_t)myFramePointer & 0x03) && (myFramePointer < ending); 
@@ -969,9 +1108,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
             *myFramePointer = (myCurrentGRP0 & *mP0) ? 
                 myCOLUP0 : ((myCurrentGRP1 & *mP1) ? myCOLUP1 : myCOLUBK);
 
-            if((myCurrentGRP0 & *mP0) && (myCurrentGRP1 & *mP1))
-              myCollision |= ourCollisionTable[myP0Bit | myP1Bit];
-
             ++mP0; ++mP1; ++myFramePointer;
           }
         }
@@ -1070,9 +1206,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
           {
             *myFramePointer = *mM0 ? myCOLUP0 : (*mM1 ? myCOLUP1 : myCOLUBK);
 
-            if(*mM0 && *mM1)
-              myCollision |= ourCollisionTable[myM0Bit | myM1Bit];
-
             ++mM0; ++mM1; ++myFramePointer;
           }
         }
@@ -1097,9 +1230,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
           {
             *myFramePointer = (*mM0 ? myCOLUP0 : (*mBL ? myCOLUPF : myCOLUBK));
 
-            if(*mBL && *mM0)
-              myCollision |= ourCollisionTable[myBLBit | myM0Bit];
-
             ++mBL; ++mM0; ++myFramePointer;
           }
         }
@@ -1124,9 +1254,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
           {
             *myFramePointer = (*mBL ? myCOLUPF : (*mM0 ? myCOLUP0 : myCOLUBK));
 
-            if(*mBL && *mM0)
-              myCollision |= ourCollisionTable[myBLBit | myM0Bit];
-
             ++mBL; ++mM0; ++myFramePointer;
           }
         }
@@ -1152,9 +1279,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
           {
             *myFramePointer = (*mM1 ? myCOLUP1 : (*mBL ? myCOLUPF : myCOLUBK));
 
-            if(*mBL && *mM1)
-              myCollision |= ourCollisionTable[myBLBit | myM1Bit];
-
             ++mBL; ++mM1; ++myFramePointer;
           }
         }
@@ -1180,9 +1304,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
           {
             *myFramePointer = (*mBL ? myCOLUPF : (*mM1 ? myCOLUP1 : myCOLUBK));
 
-            if(*mBL && *mM1)
-              myCollision |= ourCollisionTable[myBLBit | myM1Bit];
-
             ++mBL; ++mM1; ++myFramePointer;
           }
         }
@@ -1208,9 +1329,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
             *myFramePointer = (myCurrentGRP1 & *mP1) ? myCOLUP1 : 
                 (*mBL ? myCOLUPF : myCOLUBK);
 
-            if(*mBL && (myCurrentGRP1 & *mP1))
-              myCollision |= ourCollisionTable[myBLBit | myP1Bit];
-
             ++mBL; ++mP1; ++myFramePointer;
           }
         }
@@ -1236,9 +1354,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
             *myFramePointer = *mBL ? myCOLUPF : 
                 ((myCurrentGRP1 & *mP1) ? myCOLUP1 : myCOLUBK);
 
-            if(*mBL && (myCurrentGRP1 & *mP1))
-              myCollision |= ourCollisionTable[myBLBit | myP1Bit];
-
             ++mBL; ++mP1; ++myFramePointer;
           }
         }
@@ -1248,7 +1363,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 0 are enabled and playfield priority is not set
       case myPFBit | myP0Bit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
         uInt8* mP0 = &myCurrentP0Mask[hpos];
 
         while(myFramePointer < ending)
@@ -1263,9 +1378,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
             *myFramePointer = (myCurrentGRP0 & *mP0) ? 
                   myCOLUP0 : ((myPF & *mPF) ? myCOLUPF : myCOLUBK);
 
-            if((myPF & *mPF) && (myCurrentGRP0 & *mP0))
-              myCollision |= ourCollisionTable[myPFBit | myP0Bit];
-
             ++mPF; ++mP0; ++myFramePointer;
           }
         }
@@ -1276,7 +1388,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 0 are enabled and playfield priority is set
       case myPFBit | myP0Bit | PriorityBit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
         uInt8* mP0 = &myCurrentP0Mask[hpos];
 
         while(myFramePointer < ending)
@@ -1291,9 +1403,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
             *myFramePointer = (myPF & *mPF) ? myCOLUPF : 
                 ((myCurrentGRP0 & *mP0) ? myCOLUP0 : myCOLUBK);
 
-            if((myPF & *mPF) && (myCurrentGRP0 & *mP0))
-              myCollision |= ourCollisionTable[myPFBit | myP0Bit];
-
             ++mPF; ++mP0; ++myFramePointer;
           }
         }
@@ -1304,7 +1413,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 1 are enabled and playfield priority is not set
       case myPFBit | myP1Bit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
         uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
@@ -1319,9 +1428,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
             *myFramePointer = (myCurrentGRP1 & *mP1) ? 
                   myCOLUP1 : ((myPF & *mPF) ? myCOLUPF : myCOLUBK);
 
-            if((myPF & *mPF) && (myCurrentGRP1 & *mP1))
-              myCollision |= ourCollisionTable[myPFBit | myP1Bit];
-
             ++mPF; ++mP1; ++myFramePointer;
           }
         }
@@ -1332,7 +1438,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 1 are enabled and playfield priority is set
       case myPFBit | myP1Bit | PriorityBit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
         uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
@@ -1347,9 +1453,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
             *myFramePointer = (myPF & *mPF) ? myCOLUPF : 
                 ((myCurrentGRP1 & *mP1) ? myCOLUP1 : myCOLUBK);
 
-            if((myPF & *mPF) && (myCurrentGRP1 & *mP1))
-              myCollision |= ourCollisionTable[myPFBit | myP1Bit];
-
             ++mPF; ++mP1; ++myFramePointer;
           }
         }
@@ -1361,7 +1464,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myPFBit | myBLBit:
       case myPFBit | myBLBit | PriorityBit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
         uInt8* mBL = &myCurrentBLMask[hpos];
 
         while(myFramePointer < ending)
@@ -1375,9 +1478,6 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
           {
             *myFramePointer = ((myPF & *mPF) || *mBL) ? myCOLUPF : myCOLUBK;
 
-            if((myPF & *mPF) && *mBL)
-              myCollision |= ourCollisionTable[myPFBit | myBLBit];
-
             ++mPF; ++mBL; ++myFramePointer;
           }
         }
@@ -1387,6 +1487,16 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       // Handle all of the other cases
       default:
       {
+#ifdef TIA_VECTOR_RENDERER
+        // Draw 16 pixels at a time, leaving the rest for the loop below
+        if(clocksToUpdate >= 16)
+        {
+          uInt32 blocks = clocksToUpdate / 16;
+          updateFrameObjects(blocks, hpos);
+          myFramePointer += blocks * 16;
+          hpos += blocks * 16;
+        }
+#endif
         for(; myFramePointer < ending; ++myFramePointer, ++hpos)
         {
           uInt8 enabled = (myPF & myCurrentPFMask[hpos]) ? myPFBit : 0;
@@ -1406,9 +1516,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
           if((myEnabledObjects & myM0Bit) && myCurrentM0Mask[hpos])
             enabled |= myM0Bit;
 
-          myCollision |= ourCollisionTable[enabled];
-		  //*myFramePointer = myColor[myPriorityEncoder[hpos < 80 ? 0 : 1]
-           *((uInt32*)myFramePointer) = myColor[myPriorityEncoder[hpos < 80 ? 0 : 1]
+          *myFramePointer = myColor[myPriorityEncoder[hpos < 80 ? 0 : 1]
               [enabled | myPlayfieldPriorityAndScore]];
         }
         break;  
@@ -1418,6 +1526,182 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
   myFramePointer = ending;
 }
 
+#ifdef TIA_VECTOR_RENDERER
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::updateFrameObjects(uInt32 blocks, uInt32 hpos)
+{
+  const Vector zero = vecSet(0);
+  const Vector colorBK = vecSet(myCOLUBK), colorPF = vecSet(myCOLUPF);
+  const Vector colorP0 = vecSet(myCOLUP0), colorP1 = vecSet(myCOLUP1);
+  const Vector grp0 = vecSet(myCurrentGRP0), grp1 = vecSet(myCurrentGRP1);
+  const bool priority = (myPlayfieldPriorityAndScore & PriorityBit) != 0;
+  const bool score = (myPlayfieldPriorityAndScore & ScoreBit) != 0;
+
+  uInt8* frame = myFramePointer;
+  for(uInt32 x = hpos; blocks > 0; --blocks, x += 16, frame += 16)
+  {
+    Vector pf = vecTest32(&myCurrentPFMask[x], myPF);
+    Vector bl = (myEnabledObjects & myBLBit) ?
+        vecNonZero(vecLoad(&myCurrentBLMask[x])) : zero;
+    Vector p1 = vecNonZero(vecAnd(vecLoad(&myCurrentP1Mask[x]), grp1));
+    Vector m1 = (myEnabledObjects & myM1Bit) ?
+        vecNonZero(vecLoad(&myCurrentM1Mask[x])) : zero;
+    Vector p0 = vecNonZero(vecAnd(vecLoad(&myCurrentP0Mask[x]), grp0));
+    Vector m0 = (myEnabledObjects & myM0Bit) ?
+        vecNonZero(vecLoad(&myCurrentM0Mask[x])) : zero;
+
+    // Resolve the color using the same priorities as myPriorityEncoder
+    Vector color = colorBK;
+    if(priority)
+    {
+      color = vecSelect(vecOr(p1, m1), colorP1, color);
+      color = vecSelect(vecOr(p0, m0), colorP0, color);
+      color = vecSelect(vecOr(bl, pf), colorPF, color);
+    }
+    else
+    {
+      Vector colorScore = colorPF;
+      if(score)
+      {
+        uInt32 left = (x < 80) ? BSPF_min(80 - x, 16u) : 0;
+        colorScore = vecSelect(vecFirstLanes(left), colorP0, colorP1);
+      }
+      color = vecSelect(bl, colorPF, color);
+      color = vecSelect(pf, colorScore, color);
+      color = vecSelect(vecOr(p1, m1), colorP1, color);
+      color = vecSelect(vecOr(p0, m0), colorP0, color);
+    }
+    vecStore(frame, color);
+  }
+}
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::updateCollisions(uInt32 hpos, uInt32 clocks)
+{
+  uInt8 enabled = myEnabledObjects & 0x3F;
+
+  // Forget the pairs with an object which has been turned off
+  myObjectLineCollisions &= ourCollisionTable[enabled];
+
+  // Build the lines of the objects which have changed since the last time
+  const void* masks[6] = { myCurrentP0Mask, myCurrentM0Mask, 
+      myCurrentP1Mask, myCurrentM1Mask, myCurrentBLMask, myCurrentPFMask };
+  uInt32 graphics[6] = { myCurrentGRP0, 0, myCurrentGRP1, 0, 0, myPF };
+  uInt8 changed = enabled & ~myObjectLinesEnabled;
+  for(uInt32 i = 0; i < 6; ++i)
+  {
+    if((enabled & (1 << i)) && ((myObjectLineMasks[i] != masks[i]) || 
+        (myObjectLineGraphics[i] != graphics[i])))
+    {
+      computeObjectLine(i, myObjectLines[i]);
+      myObjectLineMasks[i] = masks[i];
+      myObjectLineGraphics[i] = graphics[i];
+      changed |= (1 << i);
+    }
+  }
+  myObjectLinesEnabled = enabled;
+
+  // Find again the pairs of a changed object which share a pixel 
+  // somewhere on the lines
+  for(uInt32 a = 0; changed != 0; ++a, changed >>= 1)
+  {
+    if(!(changed & 1))
+      continue;
+
+    const uInt32* line = myObjectLines[a];
+    for(uInt32 b = 0; b < 6; ++b)
+    {
+      if((b == a) || !(enabled & (1 << b)))
+        continue;
+
+      const uInt32* other = myObjectLines[b];
+      uInt16 collision = ourCollisionTable[(1 << a) | (1 << b)];
+      if((line[0] & other[0]) | (line[1] & other[1]) | 
+          (line[2] & other[2]) | (line[3] & other[3]) | (line[4] & other[4]))
+        myObjectLineCollisions |= collision;
+      else
+        myObjectLineCollisions &= ~collision;
+    }
+  }
+
+  // Most of the time none of those pairs is left to latch
+  if(!(myObjectLineCollisions & ~myCollision))
+    return;
+
+  // The bits of the pixels being drawn
+  uInt32 range[5];
+  for(uInt32 w = 0; w < 5; ++w)
+  {
+    uInt32 first = BSPF_max(hpos, w * 32), last = BSPF_min(hpos + clocks, 
+        w * 32 + 32);
+    if(first >= last)
+      range[w] = 0;
+    else if(last - first == 32)
+      range[w] = 0xFFFFFFFF;
+    else
+      range[w] = ((1 << (last - first)) - 1) << (first - w * 32);
+  }
+
+  // Check those pairs for a shared pixel among the ones being drawn
+  for(uInt32 a = 0; a < 6; ++a)
+  {
+    for(uInt32 b = a + 1; b < 6; ++b)
+    {
+      uInt16 collision = ourCollisionTable[(1 << a) | (1 << b)];
+      if(!(myObjectLineCollisions & collision) || (myCollision & collision))
+        continue;
+
+      for(uInt32 w = 0; w < 5; ++w)
+      {
+        if(myObjectLines[a][w] & myObjectLines[b][w] & range[w])
+        {
+          myCollision |= collision;
+          break;
+        }
+      }
+    }
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool TIA::sameAsLineAbove()
+{
+  LineState& above = myLineAbove;
+  bool same = myLineAboveValid &&
+      (above.pfMask == myCurrentPFMask) &&
+      (above.masks[0] == myCurrentP0Mask) &&
+      (above.masks[1] == myCurrentM0Mask) &&
+      (above.masks[2] == myCurrentP1Mask) &&
+      (above.masks[3] == myCurrentM1Mask) &&
+      (above.masks[4] == myCurrentBLMask) &&
+      (above.pf == myPF) &&
+      (above.colors[0] == myColor[0]) && (above.colors[1] == myColor[1]) &&
+      (above.colors[2] == myColor[2]) && (above.colors[3] == myColor[3]) &&
+      (above.grp0 == myCurrentGRP0) && (above.grp1 == myCurrentGRP1) &&
+      (above.enabledObjects == myEnabledObjects) &&
+      (above.priorityAndScore == myPlayfieldPriorityAndScore);
+
+  if(!same)
+  {
+    above.pfMask = myCurrentPFMask;
+    above.masks[0] = myCurrentP0Mask;
+    above.masks[1] = myCurrentM0Mask;
+    above.masks[2] = myCurrentP1Mask;
+    above.masks[3] = myCurrentM1Mask;
+    above.masks[4] = myCurrentBLMask;
+    above.pf = myPF;
+    for(uInt32 i = 0; i < 4; ++i)
+      above.colors[i] = myColor[i];
+    above.grp0 = myCurrentGRP0;
+    above.grp1 = myCurrentGRP1;
+    above.enabledObjects = myEnabledObjects;
+    above.priorityAndScore = myPlayfieldPriorityAndScore;
+    myLineAboveValid = true;
+  }
+  return same;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIA::updateFrame(Int32 clock)
 {
@@ -1483,7 +1767,43 @@ void TIA::updateFrame(Int32 clock)
     // Update as much of the scanline as we can
     if(clocksToUpdate != 0)
     {
-      updateFrameScanline(clocksToUpdate, clocksFromStartOfScanLine - HBLANK);
+      // Objects can only collide when at least two of them are on, and
+      // their collisions are found a line of pixels at a time
+      if(!(myVBLANK & 0x02) && (myEnabledObjects & (myEnabledObjects - 1)) &&
+          (myCollision != 0x7FFF))
+      {
+        updateCollisions(clocksFromStartOfScanLine - HBLANK, clocksToUpdate);
+      }
+
+      // A whole scanline drawn from the same state as the one above it
+      // is a copy of that one (blank and background only scanlines are
+      // quicker to fill than to copy)
+      if(myDrawFrame && (clocksFromStartOfScanLine == startOfScanLine) &&
+          (myClocksToEndOfScanLine == 228) && !myHMOVEBlankEnabled &&
+          (myEnabledObjects != 0) && !(myVBLANK & 0x02))
+      {
+        if(sameAsLineAbove())
+        {
+          memcpy(myFramePointer, myFramePointer - myFramePitch, clocksToUpdate);
+          myFramePointer += clocksToUpdate;
+        }
+        else
+        {
+          updateFrameScanline(clocksToUpdate, 
+              clocksFromStartOfScanLine - HBLANK);
+        }
+      }
+      else
+      {
+        myLineAboveValid = false;
+        if(myDrawFrame)
+        {
+          updateFrameScanline(clocksToUpdate, 
+              clocksFromStartOfScanLine - HBLANK);
+        }
+        else
+          myFramePointer += clocksToUpdate;
+      }
     }
 
     // Handle HMOVE blanks if they are enabled
@@ -1491,7 +1811,8 @@ void TIA::updateFrame(Int32 clock)
         (clocksFromStartOfScanLine < (HBLANK + 8)))
     {
       Int32 blanks = (HBLANK + 8) - clocksFromStartOfScanLine;
-      memset(oldFramePointer, 0, blanks);
+      if(myDrawFrame)
+        memset(oldFramePointer, 0, blanks);
 
       if((clocksToUpdate + clocksFromStartOfScanLine) >= (HBLANK + 8))
       {
@@ -1502,7 +1823,11 @@ void TIA::updateFrame(Int32 clock)
     // See if we're at the end of a scanline
     if(myClocksToEndOfScanLine == 228)
     {
-      myFramePointer -= (160 - myFrameWidth - myFrameXStart);
+      myFramePointer += myFramePitch - (160 - myFrameXStart);
+
+      // Send the finished scanline to an RGB output buffer
+      if(myDrawFrame && (myOutputBuffer != 0) && (myOutputFormat != Indexed8))
+        convertLine((myFramePointer - myCurrentFrameBuffer) / 160 - 1);
 
       // Yes, so set PF mask based on current CTRLPF reflection state 
       myCurrentPFMask = ourPlayfieldTable[myCTRLPF & 0x01];
@@ -1547,7 +1872,6 @@ void TIA::updateFrame(Int32 clock)
               [myNUSIZ0 & 0x07][(myNUSIZ0 & 0x30) >> 4][160 - (myPOSM0 & 0xFC)];
         }
       }
-		for (uInt32 i=0;i<160;i++) *myDSFramePointer++ = *(myFramePointer+160+i);
     }
   } 
   while(myClockAtLastUpdate < clock);
@@ -1565,10 +1889,196 @@ void TIA::waitHorizontalSync()
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool TIA::save(Serializer& out)
+{
+  // The state is saved with every write drawn and applied
+  flushPendingWrites();
+
+  out.putString(name());
+
+  // Where the beam is in the current frame, saved as if the frame had
+  // a pitch of 160 so the state doesn't depend on the output buffer
+  uInt32 offset = myFramePointer - currentFrameBuffer();
+  out.putInt((offset / myFramePitch) * 160 + (offset % myFramePitch));
+  for(uInt32 line = 0; line < 300; ++line)
+    out.putBytes(currentFrameBuffer() + line * myFramePitch, 160);
+
+  out.putInt(myClockWhenFrameStarted);
+  out.putInt(myClockStartDisplay);
+  out.putInt(myClockStopDisplay);
+  out.putInt(myClockAtLastUpdate);
+  out.putInt(myClocksToEndOfScanLine);
+  out.putInt(myScanlineCountForLastFrame);
+  out.putInt(myVSYNCFinishClock);
+
+  // The registers
+  out.putByte(myEnabledObjects);
+  out.putByte(myVSYNC);
+  out.putByte(myVBLANK);
+  out.putByte(myNUSIZ0);
+  out.putByte(myNUSIZ1);
+  for(uInt32 i = 0; i < 4; ++i)
+    out.putInt(myColor[i]);
+  out.putByte(myCTRLPF);
+  out.putByte(myPlayfieldPriorityAndScore);
+  out.putBool(myREFP0);
+  out.putBool(myREFP1);
+  out.putInt(myPF);
+  out.putByte(myGRP0);
+  out.putByte(myGRP1);
+  out.putByte(myDGRP0);
+  out.putByte(myDGRP1);
+  out.putBool(myENAM0);
+  out.putBool(myENAM1);
+  out.putBool(myENABL);
+  out.putBool(myDENABL);
+  out.putByte(myHMP0);
+  out.putByte(myHMP1);
+  out.putByte(myHMM0);
+  out.putByte(myHMM1);
+  out.putByte(myHMBL);
+  out.putBool(myVDELP0);
+  out.putBool(myVDELP1);
+  out.putBool(myVDELBL);
+  out.putBool(myRESMP0);
+  out.putBool(myRESMP1);
+  out.putShort(myCollision);
+  out.putShort(myPOSP0);
+  out.putShort(myPOSP1);
+  out.putShort(myPOSM0);
+  out.putShort(myPOSM1);
+  out.putShort(myPOSBL);
+
+  // The current object masks are kept as offsets into their tables
+  out.putByte(myCurrentGRP0);
+  out.putByte(myCurrentGRP1);
+  out.putInt(myCurrentBLMask - &ourBallMaskTable[0][0][0]);
+  out.putInt((myCurrentM0Mask == ourDisabledMaskTable) ? 0xFFFFFFFF :
+      myCurrentM0Mask - &ourMissleMaskTable[0][0][0][0]);
+  out.putInt(myCurrentM1Mask - &ourMissleMaskTable[0][0][0][0]);
+  out.putInt(myCurrentP0Mask - &ourPlayerMaskTable[0][0][0][0]);
+  out.putInt(myCurrentP1Mask - &ourPlayerMaskTable[0][0][0][0]);
+  out.putInt(myCurrentPFMask - &ourPlayfieldTable[0][0]);
+
+  out.putInt(myDumpDisabledCycle);
+  out.putBool(myDumpEnabled);
+  out.putInt(myLastHMOVEClock);
+  out.putBool(myHMOVEBlankEnabled);
+  out.putBool(myAllowHMOVEBlanks);
+  out.putBool(myM0CosmicArkMotionEnabled);
+  out.putInt(myM0CosmicArkCounter);
+
+  if(!mySound.save(out))
+    return false;
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool TIA::load(Deserializer& in)
+{
+  if(in.getString() != name())
+    return false;
+
+  // The writes held back belong to the state being replaced
+  myPendingWriteCount = 0;
+
+  // Where the beam is in the current frame
+  uInt32 offset = in.getInt();
+  myFramePointer = currentFrameBuffer() + 
+      (offset / 160) * myFramePitch + (offset % 160);
+  for(uInt32 line = 0; line < 300; ++line)
+  {
+    in.getBytes(currentFrameBuffer() + line * myFramePitch, 160);
+    if((myOutputBuffer != 0) && (myOutputFormat != Indexed8) &&
+       (line < myFrameHeight))
+      convertLine(line);
+  }
+
+  myClockWhenFrameStarted = (Int32)in.getInt();
+  myClockStartDisplay = (Int32)in.getInt();
+  myClockStopDisplay = (Int32)in.getInt();
+  myClockAtLastUpdate = (Int32)in.getInt();
+  myClocksToEndOfScanLine = (Int32)in.getInt();
+  myScanlineCountForLastFrame = (Int32)in.getInt();
+  myVSYNCFinishClock = (Int32)in.getInt();
+
+  // The registers
+  myEnabledObjects = in.getByte();
+  myVSYNC = in.getByte();
+  myVBLANK = in.getByte();
+  myNUSIZ0 = in.getByte();
+  myNUSIZ1 = in.getByte();
+  for(uInt32 i = 0; i < 4; ++i)
+    myColor[i] = in.getInt();
+  myCTRLPF = in.getByte();
+  myPlayfieldPriorityAndScore = in.getByte();
+  myREFP0 = in.getBool();
+  myREFP1 = in.getBool();
+  myPF = in.getInt();
+  myGRP0 = in.getByte();
+  myGRP1 = in.getByte();
+  myDGRP0 = in.getByte();
+  myDGRP1 = in.getByte();
+  myENAM0 = in.getBool();
+  myENAM1 = in.getBool();
+  myENABL = in.getBool();
+  myDENABL = in.getBool();
+  myHMP0 = (Int8)in.getByte();
+  myHMP1 = (Int8)in.getByte();
+  myHMM0 = (Int8)in.getByte();
+  myHMM1 = (Int8)in.getByte();
+  myHMBL = (Int8)in.getByte();
+  myVDELP0 = in.getBool();
+  myVDELP1 = in.getBool();
+  myVDELBL = in.getBool();
+  myRESMP0 = in.getBool();
+  myRESMP1 = in.getBool();
+  myCollision = in.getShort();
+  myPOSP0 = (Int16)in.getShort();
+  myPOSP1 = (Int16)in.getShort();
+  myPOSM0 = (Int16)in.getShort();
+  myPOSM1 = (Int16)in.getShort();
+  myPOSBL = (Int16)in.getShort();
+
+  // The current object masks are kept as offsets into their tables
+  myCurrentGRP0 = in.getByte();
+  myCurrentGRP1 = in.getByte();
+  myCurrentBLMask = &ourBallMaskTable[0][0][0] + in.getInt();
+  uInt32 m0 = in.getInt();
+  myCurrentM0Mask = (m0 == 0xFFFFFFFF) ? ourDisabledMaskTable :
+      &ourMissleMaskTable[0][0][0][0] + m0;
+  myCurrentM1Mask = &ourMissleMaskTable[0][0][0][0] + in.getInt();
+  myCurrentP0Mask = &ourPlayerMaskTable[0][0][0][0] + in.getInt();
+  myCurrentP1Mask = &ourPlayerMaskTable[0][0][0][0] + in.getInt();
+  myCurrentPFMask = &ourPlayfieldTable[0][0] + in.getInt();
+  for(uInt32 j = 0; j < 6; ++j)
+  {
+    myObjectLineMasks[j] = 0;
+  }
+  myObjectLinesEnabled = 0;
+  myLineAboveValid = false;
+
+  myDumpDisabledCycle = (Int32)in.getInt();
+  myDumpEnabled = in.getBool();
+  myLastHMOVEClock = (Int32)in.getInt();
+  myHMOVEBlankEnabled = in.getBool();
+  myAllowHMOVEBlanks = in.getBool();
+  myM0CosmicArkMotionEnabled = in.getBool();
+  myM0CosmicArkCounter = in.getInt();
+
+  if(!mySound.load(in))
+    return false;
+
+  return in.isValid();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 TIA::peek(uInt16 addr)
 {
   // Update frame to current color clock before we look at anything!
+  flushPendingWrites();
   updateFrame(mySystem->cycles() * 3);
 
   uInt8 noise = mySystem->getDataBusState() & 0x3F;
@@ -1743,8 +2253,37 @@ void TIA::poke(uInt16 addr, uInt8 value)
     delay = d[(x / 3) & 3];
   }
 
-  // Update frame to current CPU cycle before we make any changes!
-  updateFrame(clock + delay);
+  // The sync, blank and audio registers act on the rest of the system right
+  // away, the others only change what's drawn and can wait for the end of
+  // the scanline when rendering catches up
+  bool deferred = myCatchUpRendering && (addr > 0x02) &&
+      ((addr < 0x15) || (addr > 0x1A));
+
+  if(deferred)
+  {
+    // Draw the writes of an earlier scanline, or of a full buffer, first
+    if((myPendingWriteCount == 32) || (clock >= myPendingWritesLineEnd))
+    {
+      flushPendingWrites();
+    }
+    if(myPendingWriteCount == 0)
+    {
+      myPendingWritesLineEnd = clock + 228 - 
+          ((clock - myClockWhenFrameStarted) % 228);
+    }
+
+    PendingWrite& write = myPendingWrites[myPendingWriteCount++];
+    write.clock = clock;
+    write.delay = delay;
+    write.addr = addr;
+    write.value = value;
+  }
+  else
+  {
+    // Update frame to current CPU cycle before we make any changes!
+    flushPendingWrites();
+    updateFrame(clock + delay);
+  }
 
   // If a VSYNC hasn't been generated in time go ahead and end the frame
   if(((clock - myClockWhenFrameStarted) / 228) > myMaximumNumberOfScanlines)
@@ -1752,6 +2291,28 @@ void TIA::poke(uInt16 addr, uInt8 value)
     mySystem->m6502().stop();
   }
 
+  if(!deferred)
+  {
+    pokeRegister(addr, value, clock);
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::flushPendingWrites()
+{
+  // Replay the writes exactly as poke() would have made them
+  for(uInt32 i = 0; i < myPendingWriteCount; ++i)
+  {
+    const PendingWrite& write = myPendingWrites[i];
+    updateFrame(write.clock + write.delay);
+    pokeRegister(write.addr, write.value, write.clock);
+  }
+  myPendingWriteCount = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::pokeRegister(uInt16 addr, uInt8 value, Int32 clock)
+{
   switch(addr)
   {
     case 0x00:    // Vertical sync set-clear
@@ -1978,7 +2539,8 @@ void TIA::poke(uInt16 addr, uInt8 value)
       Int32 newx = hpos < HBLANK ? 3 : (((hpos - HBLANK) + 5) % 160);
 
       // Find out under what condition the player is being reset
-      Int8 when = ourPlayerPositionResetWhenTable[myNUSIZ0 & 7][myPOSP0][newx];
+      Int8 when = ourPlayerPositionResetWhenTable[myNUSIZ0 & 7]
+          [(newx + 160 - myPOSP0) % 160];
 
       // Player is being reset during the display of one of its copies
       if(when == 1)
@@ -2022,7 +2584,8 @@ void TIA::poke(uInt16 addr, uInt8 value)
       Int32 newx = hpos < HBLANK ? 3 : (((hpos - HBLANK) + 5) % 160);
 
       // Find out under what condition the player is being reset
-      Int8 when = ourPlayerPositionResetWhenTable[myNUSIZ1 & 7][myPOSP1][newx];
+      Int8 when = ourPlayerPositionResetWhenTable[myNUSIZ1 & 7]
+          [(newx + 160 - myPOSP1) % 160];
 
       // Player is being reset during the display of one of its copies
       if(when == 1)
@@ -2502,15 +3065,43 @@ void TIA::togglePalette()
   ourActualPalette = 1 - ourActualPalette;
   myFrameHeight = (ourActualPalette ? 250 : 210);
   myStopDisplayOffset = myStartDisplayOffset + 228 * (ourActualPalette ? 250 : 210);
+  computeOutputPalette();
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool TIA::ourMaskTablesComputed = false;
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 TIA::ourBallMaskTable[4][4][320];
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt16 TIA::ourCollisionTable[64];
+uInt32 TIA::ourBallLineTable[4][5];
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 TIA::ourMissleLineTable[8][4][5];
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 TIA::ourPlayerLineTable[2][8][2][16][5];
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 TIA::ourPlayfieldLineTable[2][5][16][5];
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// The collision register bits set by each combination of the object bits
+// (P0, M0, P1, M1, BL, PF from bit 0 up)
+const uInt16 TIA::ourCollisionTable[64] = {
+  0x0000, 0x0000, 0x0000, 0x0002, 0x0000, 0x2000, 0x0001, 0x2003,
+  0x0000, 0x0004, 0x4000, 0x4006, 0x0008, 0x200c, 0x4009, 0x600f,
+  0x0000, 0x0020, 0x0200, 0x0222, 0x0080, 0x20a0, 0x0281, 0x22a3,
+  0x0800, 0x0824, 0x4a00, 0x4a26, 0x0888, 0x28ac, 0x4a89, 0x6aaf,
+  0x0000, 0x0010, 0x0100, 0x0112, 0x0040, 0x2050, 0x0141, 0x2153,
+  0x0400, 0x0414, 0x4500, 0x4516, 0x0448, 0x245c, 0x4549, 0x655f,
+  0x1000, 0x1030, 0x1300, 0x1332, 0x10c0, 0x30f0, 0x13c1, 0x33f3,
+  0x1c00, 0x1c34, 0x5f00, 0x5f36, 0x1cc8, 0x3cfc, 0x5fc9, 0x7fff
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// All zeros, like every static table which isn't initialized
 uInt8 TIA::ourDisabledMaskTable[640];
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -2620,13 +3211,202 @@ const Int32 TIA::ourCompleteMotionTable[76][16] = {
 uInt8 TIA::ourPlayerMaskTable[4][2][8][320];
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Int8 TIA::ourPlayerPositionResetWhenTable[8][160][160];
+// 1 means the new position is within the display of an old copy of the
+// player, -1 means it's within the delay portion of an old copy of the
+// player, and 0 means it's neither of these two
+const Int8 TIA::ourPlayerPositionResetWhenTable[8][160] = {
+  // Mode 0
+  {
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+  },
+  // Mode 1
+  {
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+  },
+  // Mode 2
+  {
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+  },
+  // Mode 3
+  {
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+  },
+  // Mode 4
+  {
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+  },
+  // Mode 5
+  {
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+     1,  1,  1,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+  },
+  // Mode 6
+  {
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+  },
+  // Mode 7
+  {
+    -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+     1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+     1,  1,  1,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+  }
+};
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8 TIA::ourPlayerReflectTable[256];
+// Each byte with its bits in the opposite order
+const uInt8 TIA::ourPlayerReflectTable[256] = {
+  0x00, 0x80, 0x40, 0xc0, 0x20, 0xa0, 0x60, 0xe0,
+  0x10, 0x90, 0x50, 0xd0, 0x30, 0xb0, 0x70, 0xf0,
+  0x08, 0x88, 0x48, 0xc8, 0x28, 0xa8, 0x68, 0xe8,
+  0x18, 0x98, 0x58, 0xd8, 0x38, 0xb8, 0x78, 0xf8,
+  0x04, 0x84, 0x44, 0xc4, 0x24, 0xa4, 0x64, 0xe4,
+  0x14, 0x94, 0x54, 0xd4, 0x34, 0xb4, 0x74, 0xf4,
+  0x0c, 0x8c, 0x4c, 0xcc, 0x2c, 0xac, 0x6c, 0xec,
+  0x1c, 0x9c, 0x5c, 0xdc, 0x3c, 0xbc, 0x7c, 0xfc,
+  0x02, 0x82, 0x42, 0xc2, 0x22, 0xa2, 0x62, 0xe2,
+  0x12, 0x92, 0x52, 0xd2, 0x32, 0xb2, 0x72, 0xf2,
+  0x0a, 0x8a, 0x4a, 0xca, 0x2a, 0xaa, 0x6a, 0xea,
+  0x1a, 0x9a, 0x5a, 0xda, 0x3a, 0xba, 0x7a, 0xfa,
+  0x06, 0x86, 0x46, 0xc6, 0x26, 0xa6, 0x66, 0xe6,
+  0x16, 0x96, 0x56, 0xd6, 0x36, 0xb6, 0x76, 0xf6,
+  0x0e, 0x8e, 0x4e, 0xce, 0x2e, 0xae, 0x6e, 0xee,
+  0x1e, 0x9e, 0x5e, 0xde, 0x3e, 0xbe, 0x7e, 0xfe,
+  0x01, 0x81, 0x41, 0xc1, 0x21, 0xa1, 0x61, 0xe1,
+  0x11, 0x91, 0x51, 0xd1, 0x31, 0xb1, 0x71, 0xf1,
+  0x09, 0x89, 0x49, 0xc9, 0x29, 0xa9, 0x69, 0xe9,
+  0x19, 0x99, 0x59, 0xd9, 0x39, 0xb9, 0x79, 0xf9,
+  0x05, 0x85, 0x45, 0xc5, 0x25, 0xa5, 0x65, 0xe5,
+  0x15, 0x95, 0x55, 0xd5, 0x35, 0xb5, 0x75, 0xf5,
+  0x0d, 0x8d, 0x4d, 0xcd, 0x2d, 0xad, 0x6d, 0xed,
+  0x1d, 0x9d, 0x5d, 0xdd, 0x3d, 0xbd, 0x7d, 0xfd,
+  0x03, 0x83, 0x43, 0xc3, 0x23, 0xa3, 0x63, 0xe3,
+  0x13, 0x93, 0x53, 0xd3, 0x33, 0xb3, 0x73, 0xf3,
+  0x0b, 0x8b, 0x4b, 0xcb, 0x2b, 0xab, 0x6b, 0xeb,
+  0x1b, 0x9b, 0x5b, 0xdb, 0x3b, 0xbb, 0x7b, 0xfb,
+  0x07, 0x87, 0x47, 0xc7, 0x27, 0xa7, 0x67, 0xe7,
+  0x17, 0x97, 0x57, 0xd7, 0x37, 0xb7, 0x77, 0xf7,
+  0x0f, 0x8f, 0x4f, 0xcf, 0x2f, 0xaf, 0x6f, 0xef,
+  0x1f, 0x9f, 0x5f, 0xdf, 0x3f, 0xbf, 0x7f, 0xff
+};
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt32 TIA::ourPlayfieldTable[2][160];
+// The bit of the 20 bit playfield register shown at each pixel, for the
+// normal and the reflected playfield
+const uInt32 TIA::ourPlayfieldTable[2][160] = {
+  {
+    0x00001, 0x00001, 0x00001, 0x00001, 0x00002, 0x00002, 0x00002, 0x00002,
+    0x00004, 0x00004, 0x00004, 0x00004, 0x00008, 0x00008, 0x00008, 0x00008,
+    0x00800, 0x00800, 0x00800, 0x00800, 0x00400, 0x00400, 0x00400, 0x00400,
+    0x00200, 0x00200, 0x00200, 0x00200, 0x00100, 0x00100, 0x00100, 0x00100,
+    0x00080, 0x00080, 0x00080, 0x00080, 0x00040, 0x00040, 0x00040, 0x00040,
+    0x00020, 0x00020, 0x00020, 0x00020, 0x00010, 0x00010, 0x00010, 0x00010,
+    0x01000, 0x01000, 0x01000, 0x01000, 0x02000, 0x02000, 0x02000, 0x02000,
+    0x04000, 0x04000, 0x04000, 0x04000, 0x08000, 0x08000, 0x08000, 0x08000,
+    0x10000, 0x10000, 0x10000, 0x10000, 0x20000, 0x20000, 0x20000, 0x20000,
+    0x40000, 0x40000, 0x40000, 0x40000, 0x80000, 0x80000, 0x80000, 0x80000,
+    0x00001, 0x00001, 0x00001, 0x00001, 0x00002, 0x00002, 0x00002, 0x00002,
+    0x00004, 0x00004, 0x00004, 0x00004, 0x00008, 0x00008, 0x00008, 0x00008,
+    0x00800, 0x00800, 0x00800, 0x00800, 0x00400, 0x00400, 0x00400, 0x00400,
+    0x00200, 0x00200, 0x00200, 0x00200, 0x00100, 0x00100, 0x00100, 0x00100,
+    0x00080, 0x00080, 0x00080, 0x00080, 0x00040, 0x00040, 0x00040, 0x00040,
+    0x00020, 0x00020, 0x00020, 0x00020, 0x00010, 0x00010, 0x00010, 0x00010,
+    0x01000, 0x01000, 0x01000, 0x01000, 0x02000, 0x02000, 0x02000, 0x02000,
+    0x04000, 0x04000, 0x04000, 0x04000, 0x08000, 0x08000, 0x08000, 0x08000,
+    0x10000, 0x10000, 0x10000, 0x10000, 0x20000, 0x20000, 0x20000, 0x20000,
+    0x40000, 0x40000, 0x40000, 0x40000, 0x80000, 0x80000, 0x80000, 0x80000
+  },
+  {
+    0x00001, 0x00001, 0x00001, 0x00001, 0x00002, 0x00002, 0x00002, 0x00002,
+    0x00004, 0x00004, 0x00004, 0x00004, 0x00008, 0x00008, 0x00008, 0x00008,
+    0x00800, 0x00800, 0x00800, 0x00800, 0x00400, 0x00400, 0x00400, 0x00400,
+    0x00200, 0x00200, 0x00200, 0x00200, 0x00100, 0x00100, 0x00100, 0x00100,
+    0x00080, 0x00080, 0x00080, 0x00080, 0x00040, 0x00040, 0x00040, 0x00040,
+    0x00020, 0x00020, 0x00020, 0x00020, 0x00010, 0x00010, 0x00010, 0x00010,
+    0x01000, 0x01000, 0x01000, 0x01000, 0x02000, 0x02000, 0x02000, 0x02000,
+    0x04000, 0x04000, 0x04000, 0x04000, 0x08000, 0x08000, 0x08000, 0x08000,
+    0x10000, 0x10000, 0x10000, 0x10000, 0x20000, 0x20000, 0x20000, 0x20000,
+    0x40000, 0x40000, 0x40000, 0x40000, 0x80000, 0x80000, 0x80000, 0x80000,
+    0x80000, 0x80000, 0x80000, 0x80000, 0x40000, 0x40000, 0x40000, 0x40000,
+    0x20000, 0x20000, 0x20000, 0x20000, 0x10000, 0x10000, 0x10000, 0x10000,
+    0x08000, 0x08000, 0x08000, 0x08000, 0x04000, 0x04000, 0x04000, 0x04000,
+    0x02000, 0x02000, 0x02000, 0x02000, 0x01000, 0x01000, 0x01000, 0x01000,
+    0x00010, 0x00010, 0x00010, 0x00010, 0x00020, 0x00020, 0x00020, 0x00020,
+    0x00040, 0x00040, 0x00040, 0x00040, 0x00080, 0x00080, 0x00080, 0x00080,
+    0x00100, 0x00100, 0x00100, 0x00100, 0x00200, 0x00200, 0x00200, 0x00200,
+    0x00400, 0x00400, 0x00400, 0x00400, 0x00800, 0x00800, 0x00800, 0x00800,
+    0x00008, 0x00008, 0x00008, 0x00008, 0x00004, 0x00004, 0x00004, 0x00004,
+    0x00002, 0x00002, 0x00002, 0x00002, 0x00001, 0x00001, 0x00001, 0x00001
+  }
+};
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 const uInt32 TIA::ourNTSCPalette[256] = {
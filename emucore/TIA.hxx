@@ -87,6 +87,22 @@ class TIA : public Device , public MediaSource
     */
     virtual void install(System& system);
 
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The Serializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool save(Serializer& out);
+
+    /**
+      Loads the current state of this device from the given Deserializer.
+
+      @param in The Deserializer object to use
+      @return False on any errors, else true
+    */
+    virtual bool load(Deserializer& in);
+
   public:
     /**
       Get the byte at the specified address
@@ -107,22 +123,55 @@ class TIA : public Device , public MediaSource
     /**
       This method should be called at an interval corresponding to
       the desired frame rate to update the media source.
+
+      @param draw False to run the frame without drawing it
     */
-    virtual void update();
+    virtual void update(bool draw = true);
 
     /**
       Answers the current frame buffer
 
       @return Pointer to the current frame buffer
     */
-    uInt8* currentFrameBuffer() const { return myCurrentFrameBuffer; }
+    uInt8* currentFrameBuffer() const 
+    { 
+      return ((myOutputBuffer != 0) && (myOutputFormat == Indexed8)) ?
+          myOutputBuffer : myCurrentFrameBuffer; 
+    }
 
     /**
       Answers the previous frame buffer
 
       @return Pointer to the previous frame buffer
     */
-    uInt8* previousFrameBuffer() const { return myPreviousFrameBuffer; }
+    uInt8* previousFrameBuffer() const 
+    { 
+      return ((myOutputBuffer != 0) && (myOutputFormat == Indexed8)) ?
+          myOutputBuffer : myPreviousFrameBuffer; 
+    }
+
+    /**
+      Draw the frames straight into the given buffer instead of the
+      internal ones.  For the RGB formats each scanline is converted
+      through the active palette as soon as it's finished.
+
+      @param buffer The buffer to draw into, which must hold 300 lines of
+                    palette indices or height() lines of RGB pixels, or the
+                    null pointer to use the internal buffers again
+      @param pitch  The number of bytes from one line to the next
+      @param format The format of the pixels in the buffer
+    */
+    void setOutputBuffer(uInt8* buffer, uInt32 pitch, 
+        PixelFormat format = Indexed8);
+
+    /**
+      Hold back the register writes which only change what's drawn, and
+      replay them when the scanline ends or when something has to see the
+      frame up to date (a read, a sync or blank write, a state save).
+
+      @param enable Whether the writes should be held back
+    */
+    void setCatchUpRendering(bool enable);
 
     /**
       Get the palette which maps frame data to RGB values.
@@ -166,31 +215,51 @@ class TIA : public Device , public MediaSource
     // Compute the ball mask table
     void computeBallMaskTable();
 
-    // Compute the collision decode table
-    void computeCollisionTable();
-
     // Compute the missle mask table
     void computeMissleMaskTable();
 
     // Compute the player mask table
     void computePlayerMaskTable();
 
-    // Compute the player position reset when table
-    void computePlayerPositionResetWhenTable();
-
-    // Compute the player reflect table
-    void computePlayerReflectTable();
+    // Compute the 160 bit lines of the ball, missle, player and playfield
+    // masks from the mask tables
+    void computeObjectLineTables();
 
-    // Compute playfield mask table
-    void computePlayfieldMaskTable();
+    // Build the 160 bit line of the pixels covered by the given object
+    // (P0, M0, P1, M1, BL, PF in the order of their bits)
+    void computeObjectLine(uInt32 object, uInt32* line);
 
   private:
+    // Compute myOutputPalette for the output format and active palette
+    void computeOutputPalette();
+
+    // Convert a line of the current frame buffer into the RGB output buffer
+    void convertLine(uInt32 line);
+
     // Update the current frame buffer up to one scanline
     void updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos);
 
+    // Draw blocks of 16 pixels with all objects enabled, using the SSE2 or
+    // NEON vector unit (only defined when compiling for one of them)
+    void updateFrameObjects(uInt32 blocks, uInt32 hpos);
+
+    // Set the collision bits of the objects which share a pixel between
+    // hpos and hpos + clocks on the current scanline
+    void updateCollisions(uInt32 hpos, uInt32 clocks);
+
+    // Remember what the scanline about to be drawn in one go is drawn
+    // from, and tell if the scanline above was drawn from the same
+    bool sameAsLineAbove();
+
     // Update the current frame buffer to the specified color clock
     void updateFrame(Int32 clock);
 
+    // Draw up to and apply the register writes which were held back
+    void flushPendingWrites();
+
+    // Change the register at the given address, as written at the clock
+    void pokeRegister(uInt16 addr, uInt8 value, Int32 clock);
+
     // Waste cycles until the current scanline is finished
     void waitHorizontalSync();
 
@@ -214,9 +283,67 @@ class TIA : public Device , public MediaSource
     // Pointer to the previous frame buffer
     uInt8* myPreviousFrameBuffer;
 
+    // Caller supplied buffer the frames are drawn into, or the null pointer
+    // when the frames go into the two buffers above
+    uInt8* myOutputBuffer;
+
+    // Number of bytes from one line of the output buffer to the next
+    uInt32 myOutputPitch;
+
+    // Format of the pixels in the output buffer
+    PixelFormat myOutputFormat;
+
+    // The active palette translated into the output format
+    uInt32 myOutputPalette[256];
+
+    // Indicates if the pixels of the current frame are drawn; when they
+    // aren't only the collisions are worked out
+    bool myDrawFrame;
+
+    // A register write held back until its scanline is drawn
+    struct PendingWrite
+    {
+      Int32 clock;
+      Int16 delay;
+      uInt8 addr;
+      uInt8 value;
+    };
+
+    // Indicates if register writes are held back until the scanline ends
+    bool myCatchUpRendering;
+
+    // The writes held back, in the order they happened
+    PendingWrite myPendingWrites[32];
+
+    // Number of entries used in myPendingWrites
+    uInt32 myPendingWriteCount;
+
+    // Clock when the scanline of the writes held back ends
+    Int32 myPendingWritesLineEnd;
+
+    // Number of bytes from one line of the frame to the next
+    uInt32 myFramePitch;
+
     // Pointer to the next pixel that will be drawn in the current frame buffer
     uInt8* myFramePointer;
-    uInt8* myDSFramePointer;
+
+    // Everything a scanline's pixels are drawn from
+    struct LineState
+    {
+      const uInt32* pfMask;
+      const uInt8* masks[5];
+      uInt32 pf;
+      uInt32 colors[4];
+      uInt8 grp0;
+      uInt8 grp1;
+      uInt8 enabledObjects;
+      uInt8 priorityAndScore;
+    };
+
+    // What the scanline just above was drawn from, when it was drawn in
+    // one go from that state so it can be copied
+    LineState myLineAbove;
+    bool myLineAboveValid;
 
     // Indicates where the scanline should start being displayed
     uInt32 myFrameXStart;
@@ -331,6 +458,17 @@ class TIA : public Device , public MediaSource
 
     uInt16 myCollision;    // Collision register
 
+    // 160 bit lines of the pixels covered by P0, M0, P1, M1, BL and PF on
+    // the scanline, with the masks and graphics they were built from
+    uInt32 myObjectLines[6][5];
+    const void* myObjectLineMasks[6];
+    uInt32 myObjectLineGraphics[6];
+
+    // The objects which were on, and the collision bits of the pairs of
+    // them which share a pixel somewhere on the lines
+    uInt8 myObjectLinesEnabled;
+    uInt16 myObjectLineCollisions;
+
     // Note that these position registers contain the color clock 
     // on which the object's serial output should begin (0 to 159)
     Int16 myPOSP0;         // Player 0 position register
@@ -368,7 +506,7 @@ class TIA : public Device , public MediaSource
     uInt8* myCurrentP1Mask;
 
     // Pointer to the currently active mask array for the playfield
-    uInt32* myCurrentPFMask;
+    const uInt32* myCurrentPFMask;
 
   private:
     // Indicates when the dump for paddles was last set
@@ -394,11 +532,22 @@ class TIA : public Device , public MediaSource
     uInt32 myM0CosmicArkCounter;
 
   private:
+    // Indicates if the ball, missle and player mask tables have been computed
+    static bool ourMaskTablesComputed;
+
     // Ball mask table (entries are true or false)
     static uInt8 ourBallMaskTable[4][4][320];
 
+    // 160 bit lines of the pixels covered by each object at position 0
+    // (pixel x in bit x % 32 of word x / 32), with one line for each value
+    // of each nibble of the player graphics and of the playfield register
+    static uInt32 ourBallLineTable[4][5];
+    static uInt32 ourMissleLineTable[8][4][5];
+    static uInt32 ourPlayerLineTable[2][8][2][16][5];
+    static uInt32 ourPlayfieldLineTable[2][5][16][5];
+
     // Used to set the collision register to the correct value
-    static uInt16 ourCollisionTable[64];
+    static const uInt16 ourCollisionTable[64];
 
     // A mask table which can be used when an object is disabled
     static uInt8 ourDisabledMaskTable[640];
@@ -419,14 +568,15 @@ class TIA : public Device , public MediaSource
     // Player mask table
     static uInt8 ourPlayerMaskTable[4][2][8][320];
 
-    // Indicates if player is being reset during delay, display or other times
-    static Int8 ourPlayerPositionResetWhenTable[8][160][160];
+    // Indicates if player is being reset during delay, display or other times,
+    // indexed by the distance from the player's position to the new one
+    static const Int8 ourPlayerPositionResetWhenTable[8][160];
 
     // Used to reflect a players graphics
-    static uInt8 ourPlayerReflectTable[256];
+    static const uInt8 ourPlayerReflectTable[256];
 
     // Playfield mask table for reflected and non-reflected playfields
-    static uInt32 ourPlayfieldTable[2][160];
+    static const uInt32 ourPlayfieldTable[2][160];
 
     // Table of RGB values for NTSC
     static const uInt32 ourNTSCPalette[256];
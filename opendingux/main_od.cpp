@@ -8,23 +8,28 @@ unsigned int gameCRC;
 gamecfg GameConf;
 char gameName[512];
 char current_conf_app[MAX__PATH];
-unsigned char vidBuf[256*256];
+static unsigned short vidBuf[SYSVID_WIDTH*300];
+static int graphics_direct = 0;
 
 unsigned long nextTick, lastTick = 0, newTick, currentTick, wait;
 int FPS = 60; 
 int pastFPS = 0; 
 
+// Frames in a row which can be run without drawing them when the emulation
+// falls behind, and how many have been so far
+#define FRAMESKIP_MAX 4
+int skippedFrames = 0;
+
 SDL_Surface *layer,*layerback,*layerbackgrey;
 SDL_Surface *actualScreen, *screen;
 SDL_Event event;
 
 Console* theConsole = (Console*) NULL;
+RewindBuffer* theRewind = (RewindBuffer*) NULL;
 Sound* theSDLSnd = (Sound*) NULL;
 uInt8* filebuffer = 0;
 uInt32 console_controleurtype = 0;
 
-unsigned short stella_palette[256];
-
 unsigned long SDL_UXTimerRead(void) {
 	struct timeval tval; // timing
   
@@ -32,56 +37,52 @@ unsigned long SDL_UXTimerRead(void) {
 	return (((tval.tv_sec*1000000) + (tval.tv_usec )));
 }
 
+// Point the TIA at where the next frame goes: straight into the middle of
+// the screen at original size, or into vidBuf to be stretched to full screen
+void graphics_setoutput(void) {
+	MediaSource& media = *theConsole->myMediaSource;
+	int x = (actualScreen->w - SYSVID_WIDTH) / 2;
+	int y = (actualScreen->h - (int) media.height()) / 2;
+
+	graphics_direct = (!GameConf.m_ScreenRatio && (y >= 0));
+	if (graphics_direct)
+		media.setOutputBuffer((uInt8*) actualScreen->pixels + y * actualScreen->pitch + x * 2,
+			actualScreen->pitch, MediaSource::RGB565);
+	else
+		media.setOutputBuffer((uInt8*) vidBuf, SYSVID_WIDTH * 2, MediaSource::RGB565);
+}
+
 void graphics_paint(void) {
 	unsigned short *buffer_scr = (unsigned short *) actualScreen->pixels;
-	unsigned char *buffer_flip = (unsigned char *) &vidBuf;
 	unsigned int W,H,ix,iy,x,y, xfp,yfp;
 	static char buffer[32];
 
 	if(SDL_MUSTLOCK(actualScreen)) SDL_LockSurface(actualScreen);
 	
-	if (GameConf.m_ScreenRatio) { // Full screen
+	if (!graphics_direct) { // Full screen, or a frame too tall for the screen
 		x=0;
 		y=0; 
 		W=320;
 		H=240;
 		ix=(SYSVID_WIDTH<<16)/W;
-		iy=(SYSVID_HEIGHT<<16)/H;
+		iy=(theConsole->myMediaSource->height()<<16)/H;
 		xfp = 300;yfp = 1;
 
 		do   
 		{
-			unsigned char *buffer_mem=(buffer_flip+((y>>16)*SYSVID_WIDTH));
+			unsigned short *buffer_mem=(vidBuf+((y>>16)*SYSVID_WIDTH));
 			W=320; x=0;
 			do {
-				*buffer_scr++=stella_palette[buffer_mem[x>>16]];
+				*buffer_scr++=buffer_mem[x>>16];
 				x+=ix;
 			} while (--W);
 			y+=iy;
 		} while (--H);
 	}
-	else { // Original show
+	else { // Original show, the TIA has already drawn the frame on screen
 		x=((screen->w - SYSVID_WIDTH)/2);
-		y=((screen->h - SYSVID_HEIGHT)/2); 
-		W=SYSVID_WIDTH;
-		H=SYSVID_HEIGHT;
-		ix=(SYSVID_WIDTH<<16)/W;
-		iy=(SYSVID_HEIGHT<<16)/H;
+		y=((screen->h - theConsole->myMediaSource->height())/2); 
 		xfp = (x+SYSVID_WIDTH)-20;yfp = y+1;
-		
-		buffer_scr += (y)*320;
-		buffer_scr += (x);
-		do   
-		{
-			unsigned char *buffer_mem=(buffer_flip+((y>>16)*SYSVID_WIDTH));
-			W=SYSVID_WIDTH; x=((screen->w - SYSVID_WIDTH)/2);
-			do {
-				*buffer_scr++=stella_palette[buffer_mem[x>>16]];
-				x+=ix;
-			} while (--W);
-			y+=iy;
-			buffer_scr += actualScreen->pitch - 320 - SYSVID_WIDTH;
-		} while (--H);
 	}
 	
 	pastFPS++;
@@ -159,7 +160,7 @@ void initSDL(void) {
 	spec.freq = 44100;
 	spec.format = AUDIO_U8;
 	spec.channels = 1;
-	spec.samples = 44100/60;
+	spec.samples = 256; // processFrame() keeps the sound ring topped up every frame
 	spec.callback = audio_callback;
 	spec.userdata = NULL;
 
@@ -179,6 +180,8 @@ int stella_init(char *filename) {
 
 	if (theConsole) 
 		delete theConsole;
+	if (theRewind) 
+		delete theRewind;
 	if (theSDLSnd) 
 		delete theSDLSnd;
   
@@ -195,19 +198,9 @@ int stella_init(char *filename) {
 	fclose(romfile);
 
 	// Init the emulation
-	theConsole = new Console((const uInt8*) filebuffer, buffer_size, "noname", *theSDLSnd);
-	
-	// Init palette
-	const uInt32* gamePalette = theConsole->myMediaSource->palette();
-	for(uInt32 i = 0; i < 256; i++)	{
-		uInt8 r, g, b;
- 
-		r = (uInt8) ((gamePalette[i] & 0x00ff0000) >> 16);
-		g = (uInt8) ((gamePalette[i] & 0x0000ff00) >> 8);
-		b = (uInt8) ((gamePalette[i] & 0x000000ff) >> 0);
- 
-		stella_palette[i]=PIX_TO_RGB(actualScreen->format,r,g,b);
-	}
+	theConsole = new Console((const uInt8*) filebuffer, buffer_size, filename, *theSDLSnd);
+	theRewind = new RewindBuffer();
+	graphics_setoutput();
 	
 	return 1;
 }
@@ -270,11 +263,42 @@ int main(int argc, char *argv[]) {
 						usleep(wait);
 				}
 				
-				// Update frame
-				theConsole->update();
-
-				// Draw frame
-				graphics_paint();
+				// Run the frame without drawing it when we're already a frame
+				// late, but draw at least one in FRAMESKIP_MAX + 1 (and all of
+				// them while going back in time)
+				if (((long) (currentTick - nextTick) > (long) interval) &&
+						(skippedFrames < FRAMESKIP_MAX) && (keys[SDLK_TAB] != SDL_PRESSED)) {
+					theConsole->update(false);
+					theSDLSnd->processFrame();
+					theRewind->capture(*theConsole);
+					skippedFrames++;
+				}
+				else {
+					// The TIA draws RGB565 pixels straight into the screen surface,
+					// whose pixels move with every flip
+					graphics_setoutput();
+					if (SDL_MUSTLOCK(actualScreen)) SDL_LockSurface(actualScreen);
+
+					// Update frame, or go back in time while L is held
+					if (keys[SDLK_TAB] == SDL_PRESSED) {
+						// Step back two frames and run one so the screen is redrawn
+						if (theRewind->rewind(*theConsole) && theRewind->rewind(*theConsole)) {
+							theConsole->update();
+							theSDLSnd->processFrame();
+							theRewind->capture(*theConsole);
+						}
+					}
+					else {
+						theConsole->update();
+						theSDLSnd->processFrame();
+						theRewind->capture(*theConsole);
+					}
+					if (SDL_MUSTLOCK(actualScreen)) SDL_UnlockSurface(actualScreen);
+
+					// Draw frame
+					graphics_paint();
+					skippedFrames = 0;
+				}
 
 				// Wait for keys
 				theConsole->eventHandler().sendKeyEvent(StellaEvent::KCODE_SPACE, (keys[SDLK_LCTRL] == SDL_PRESSED));
@@ -299,6 +323,12 @@ int main(int argc, char *argv[]) {
 				else if ( (keys[SDLK_ESCAPE] == SDL_PRESSED) ) {  } // OPTIONS
 				
 				nextTick += interval;
+
+				// Don't try to catch up on more than the frames we can skip, the
+				// game just runs slower when even skipping can't keep up
+				currentTick = SDL_UXTimerRead();
+				if ((long) (currentTick - nextTick) > (long) (interval * FRAMESKIP_MAX))
+					nextTick = currentTick;
 				break;
 		}
 	}
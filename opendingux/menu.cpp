@@ -894,8 +894,10 @@ void menuSaveState(void) {
 		strcpy(szFile, gameName);
 		strcpy(strrchr(szFile, '.'), ".sta");
 		print_string("Saving...", COLOR_OK, COLOR_BG, 8,240-5 -10*3);
-		//state_store(szFile);
-		print_string("Save OK",COLOR_OK,COLOR_BG, 8+10*8,240-5 -10*3);
+		if (theConsole->saveState(szFile))
+			print_string("Save OK",COLOR_OK,COLOR_BG, 8+10*8,240-5 -10*3);
+		else
+			print_string("Save failed",COLOR_KO,COLOR_BG, 8+10*8,240-5 -10*3);
 		screen_flip();
 		screen_waitkey();
 	}
@@ -909,8 +911,10 @@ void menuLoadState(void) {
 		strcpy(szFile, gameName);
 		strcpy(strrchr(szFile, '.'), ".sta");
 		print_string("Loading...", COLOR_OK, COLOR_BG, 8,240-5 -10*3);
-		//state_restore(szFile);
-		print_string("Load OK",COLOR_OK,COLOR_BG, 8+10*8,240-5 -10*3);
+		if (theConsole->loadState(szFile))
+			print_string("Load OK",COLOR_OK,COLOR_BG, 8+10*8,240-5 -10*3);
+		else
+			print_string("Load failed",COLOR_KO,COLOR_BG, 8+10*8,240-5 -10*3);
 		screen_flip();
 		screen_waitkey();
 		gameMenu=false;
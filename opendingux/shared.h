@@ -42,8 +42,10 @@
 #include "Event.hxx"
 #include "StellaEvent.hxx"
 #include "EventHandler.hxx"
+#include "RewindBuffer.hxx"
 
 extern Console* theConsole;
+extern RewindBuffer* theRewind;
 extern Sound* theSDLSnd;
 extern uInt8* filebuffer;
 